@@ -0,0 +1,204 @@
+/*=============================================================================*/
+// Copyright 2021-2022 Elite Engine
+/*=============================================================================*/
+// EGeometry2DBatch.cpp: Worker pool and triangulating a batch of independent polygons on it.
+/*=============================================================================*/
+#include "stdafx.h"
+#include "EGeometry2DBatch.h"
+
+namespace
+{
+	//Indexed result of one polygon, the indices start at 0
+	struct PolygonMesh
+	{
+		std::vector<Elite::Vector2> vertices;
+		std::vector<std::array<int, 3>> triangles;
+		std::vector<std::array<int, 2>> lines;
+		std::vector<std::array<int, 3>> triangleLines;
+	};
+
+	void TriangulatePolygon(Elite::Polygon& polygon, Elite::TriangulationMode mode, float simplifyTolerance, PolygonMesh& result)
+	{
+		const auto& triangles = polygon.Triangulate(mode, simplifyTolerance);
+		const auto& lines = polygon.GetLines();
+
+		//Unique vertices, sorted so the result doesn't depend on anything but the triangulation
+		const auto lessPoint = [](const Elite::Vector2& a, const Elite::Vector2& b) { return a.x < b.x || (a.x == b.x && a.y < b.y); };
+		auto& vertices = result.vertices;
+		vertices.reserve(triangles.size() * 3);
+		for (const auto t : triangles)
+		{
+			vertices.push_back(t->p1);
+			vertices.push_back(t->p2);
+			vertices.push_back(t->p3);
+		}
+		std::sort(vertices.begin(), vertices.end(), lessPoint);
+		vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+		const auto getVertex = [&](const Elite::Vector2& p)
+		{
+			return static_cast<int>(std::lower_bound(vertices.begin(), vertices.end(), p, lessPoint) - vertices.begin());
+		};
+
+		result.triangles.reserve(triangles.size());
+		result.triangleLines.reserve(triangles.size());
+		for (const auto t : triangles)
+		{
+			result.triangles.push_back({ { getVertex(t->p1), getVertex(t->p2), getVertex(t->p3) } });
+#ifdef USE_TRIANGLE_METADATA
+			result.triangleLines.push_back(t->metaData.IndexLines);
+#else
+			result.triangleLines.push_back({ { -1, -1, -1 } });
+#endif
+		}
+
+		result.lines.reserve(lines.size());
+		for (const auto l : lines)
+			result.lines.push_back({ { getVertex(l->p1), getVertex(l->p2) } });
+	}
+}
+
+Elite::WorkerPool::WorkerPool(unsigned int workerCount)
+{
+	if (workerCount == 0)
+		workerCount = max(std::thread::hardware_concurrency(), 1u) - 1;
+	m_Workers.reserve(workerCount);
+	for (unsigned int i = 0; i < workerCount; ++i)
+		m_Workers.push_back(std::thread(&WorkerPool::RunWorker, this));
+}
+
+Elite::WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_IsStopping = true;
+	}
+	m_WakeWorkers.notify_all();
+	for (auto& worker : m_Workers)
+		worker.join();
+}
+
+void Elite::WorkerPool::ParallelFor(size_t count, const std::function<void(size_t)>& task)
+{
+	if (count == 0)
+		return;
+
+	Job job{ &task, count, { 0 }, 0 };
+	const auto isShared = count > 1 && !m_Workers.empty();
+	if (isShared)
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_Jobs.push_back(&job);
+	}
+	if (isShared)
+		m_WakeWorkers.notify_all();
+
+	const auto ranCount = RunTasks(job, job.next++);
+
+	//The job lives on this stack, it has to be out of the queue and every task a worker took has to be done before returning
+	std::unique_lock<std::mutex> lock{ m_Mutex };
+	job.doneCount += ranCount;
+	const auto it = std::find(m_Jobs.begin(), m_Jobs.end(), &job);
+	if (it != m_Jobs.end())
+		m_Jobs.erase(it);
+	m_JobDone.wait(lock, [&job]() { return job.doneCount == job.count; });
+}
+
+void Elite::WorkerPool::RunWorker()
+{
+	std::unique_lock<std::mutex> lock{ m_Mutex };
+	while (true)
+	{
+		m_WakeWorkers.wait(lock, [this]() { return m_IsStopping || !m_Jobs.empty(); });
+		if (m_IsStopping)
+			return;
+
+		//The first index is taken while holding the lock, the owner can't return as long as this task isn't done
+		const auto pJob = m_Jobs.front();
+		const auto index = pJob->next++;
+		if (index >= pJob->count)
+		{
+			m_Jobs.pop_front();
+			continue;
+		}
+
+		lock.unlock();
+		const auto ranCount = RunTasks(*pJob, index);
+		lock.lock();
+
+		pJob->doneCount += ranCount;
+		if (pJob->doneCount == pJob->count)
+			m_JobDone.notify_all();
+	}
+}
+
+size_t Elite::WorkerPool::RunTasks(Job& job, size_t index)
+{
+	size_t ranCount = 0;
+	for (; index < job.count; index = job.next++)
+	{
+		(*job.pTask)(index);
+		++ranCount;
+	}
+	return ranCount;
+}
+
+void Elite::TriangulatedMesh::Clear()
+{
+	vertices.clear();
+	triangles.clear();
+	lines.clear();
+	triangleLines.clear();
+	polygonFirstTriangle.clear();
+	polygonFirstVertex.clear();
+}
+
+void Elite::TriangulatePolygons(WorkerPool& pool, Polygon* pPolygons, size_t polygonCount, TriangulatedMesh& mesh,
+	TriangulationMode mode, float simplifyTolerance)
+{
+	mesh.Clear();
+
+	//Triangulate, every worker takes the next polygon until there are none left
+	std::vector<PolygonMesh> results(polygonCount);
+	pool.ParallelFor(polygonCount, [&](size_t i)
+	{
+		TriangulatePolygon(pPolygons[i], mode, simplifyTolerance, results[i]);
+	});
+
+	//Merge in polygon order, rebasing the indices
+	size_t vertexCount = 0, triangleCount = 0, lineCount = 0;
+	for (const auto& result : results)
+	{
+		vertexCount += result.vertices.size();
+		triangleCount += result.triangles.size();
+		lineCount += result.lines.size();
+	}
+	mesh.vertices.reserve(vertexCount);
+	mesh.triangles.reserve(triangleCount);
+	mesh.triangleLines.reserve(triangleCount);
+	mesh.lines.reserve(lineCount);
+	mesh.polygonFirstTriangle.reserve(polygonCount + 1);
+	mesh.polygonFirstVertex.reserve(polygonCount + 1);
+
+	for (const auto& result : results)
+	{
+		const auto vertexOffset = static_cast<int>(mesh.vertices.size());
+		const auto lineOffset = static_cast<int>(mesh.lines.size());
+		mesh.polygonFirstTriangle.push_back(static_cast<int>(mesh.triangles.size()));
+		mesh.polygonFirstVertex.push_back(vertexOffset);
+
+		mesh.vertices.insert(mesh.vertices.end(), result.vertices.begin(), result.vertices.end());
+		for (const auto& t : result.triangles)
+			mesh.triangles.push_back({ { t[0] + vertexOffset, t[1] + vertexOffset, t[2] + vertexOffset } });
+		for (const auto& l : result.lines)
+			mesh.lines.push_back({ { l[0] + vertexOffset, l[1] + vertexOffset } });
+		for (const auto& t : result.triangleLines)
+		{
+			std::array<int, 3> rebased{};
+			for (int i = 0; i < 3; ++i)
+				rebased[i] = t[i] == -1 ? -1 : t[i] + lineOffset;
+			mesh.triangleLines.push_back(rebased);
+		}
+	}
+	mesh.polygonFirstTriangle.push_back(static_cast<int>(mesh.triangles.size()));
+	mesh.polygonFirstVertex.push_back(static_cast<int>(mesh.vertices.size()));
+}
@@ -0,0 +1,77 @@
+/*=============================================================================*/
+// Copyright 2021-2022 Elite Engine
+/*=============================================================================*/
+// EGeometry2DBatch.h: Worker pool and triangulating a batch of independent polygons on it.
+/*=============================================================================*/
+#ifndef ELITE_GEOMETRY_BATCH
+#define	ELITE_GEOMETRY_BATCH
+
+#include "EGeometry2DTypes.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace Elite
+{
+	//Threads that live as long as the pool, so a batch doesn't pay for starting and joining threads every time.
+	//The thread calling ParallelFor works on its own job as well, so a ParallelFor inside a task can't wait forever on busy workers
+	class WorkerPool final
+	{
+	public:
+		//0 = one less than the hardware concurrency, the calling thread is the extra one
+		explicit WorkerPool(unsigned int workerCount = 0);
+		~WorkerPool();
+
+		WorkerPool(const WorkerPool& other) = delete;
+		WorkerPool& operator=(const WorkerPool& other) = delete;
+		WorkerPool(WorkerPool&& other) = delete;
+		WorkerPool& operator=(WorkerPool&& other) = delete;
+
+		unsigned int GetWorkerCount() const { return static_cast<unsigned int>(m_Workers.size()); }
+		//Calls task(i) for every i in [0, count) on the workers and this thread, returns when all of them are done
+		void ParallelFor(size_t count, const std::function<void(size_t)>& task);
+
+	private:
+		struct Job
+		{
+			const std::function<void(size_t)>* pTask;
+			size_t count;
+			std::atomic<size_t> next; //next index to hand out
+			size_t doneCount; //guarded by m_Mutex
+		};
+
+		void RunWorker();
+		//Runs tasks of the job starting with index, until all are handed out. Returns how many it ran
+		static size_t RunTasks(Job& job, size_t index);
+
+		std::vector<std::thread> m_Workers;
+		std::mutex m_Mutex;
+		std::condition_variable m_WakeWorkers;
+		std::condition_variable m_JobDone;
+		std::deque<Job*> m_Jobs; //jobs that still have tasks to hand out
+		bool m_IsStopping = false;
+	};
+
+	//All the triangulated polygons of a batch in one indexed mesh
+	struct TriangulatedMesh final
+	{
+		std::vector<Vector2> vertices;
+		std::vector<std::array<int, 3>> triangles; //Indices in vertices
+		std::vector<std::array<int, 2>> lines; //Indices in vertices, line matrix of all the polygons
+		std::vector<std::array<int, 3>> triangleLines; //Indices in lines, per triangle (same order as TriangleMetaData::IndexLines)
+		std::vector<int> polygonFirstTriangle; //Per polygon, with the total amount of triangles as last element
+		std::vector<int> polygonFirstVertex; //Per polygon, with the total amount of vertices as last element
+
+		void Clear();
+	};
+
+	//Triangulates every polygon (they have to be independent) on the pool and merges the results in polygon order,
+	//the indices of every polygon are rebased on the ones before it. Every polygon is triangulated on it's own,
+	//so the mesh is the same no matter how many workers the pool has.
+	void TriangulatePolygons(WorkerPool& pool, Polygon* pPolygons, size_t polygonCount, TriangulatedMesh& mesh,
+		TriangulationMode mode = TriangulationMode::EarClipping, float simplifyTolerance = 0.f);
+}
+#endif
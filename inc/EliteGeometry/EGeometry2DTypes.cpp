@@ -8,6 +8,15 @@
 //#include "EGeometry.h"
 #include "EGeometry2DTypes.h"
 #include "EGeometry2DUtilities.h"
+#include "EGeometry2DBatch.h"
+#include <map>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 #pragma region Polygon
 #pragma region Constructors
 using namespace std;
@@ -31,11 +40,9 @@ Elite::Polygon::Polygon(const std::vector<Vector2>& outerShape, const std::vecto
 	m_vPoints.assign(outerShape.begin(), outerShape.end()); //Copy
 
 	//For each child, add child
-	for (const auto i : innerShapes)
-	{
-		const auto polygon = new Polygon(i);
-		AddChild(*polygon);
-	}
+	m_vChildren.reserve(innerShapes.size());
+	for (const auto& i : innerShapes)
+		AddChild(Polygon(i));
 }
 
 Elite::Polygon::Polygon(const Vector2* vertices, int count)
@@ -55,14 +62,78 @@ Elite::Polygon::~Polygon()
 		SAFE_DELETE(l);
 	m_vpLines.clear();
 }
+
+Elite::Polygon::Polygon(const Polygon& other)
+	: m_vChildren(other.m_vChildren)
+	, m_vPoints(other.m_vPoints)
+	, m_isTriangulated(other.m_isTriangulated)
+	, m_BoundsMin(other.m_BoundsMin)
+	, m_BoundsMax(other.m_BoundsMax)
+	, m_IsBoundsDirty(other.m_IsBoundsDirty)
+{
+	m_vpTriangles.reserve(other.m_vpTriangles.size());
+	for (const auto t : other.m_vpTriangles)
+		m_vpTriangles.push_back(new Triangle(*t));
+	m_vpLines.reserve(other.m_vpLines.size());
+	for (const auto l : other.m_vpLines)
+		m_vpLines.push_back(new Line(*l));
+}
+
+Elite::Polygon::Polygon(Polygon&& other) noexcept
+	: m_vChildren(std::move(other.m_vChildren))
+	, m_vPoints(std::move(other.m_vPoints))
+	, m_vpTriangles(std::move(other.m_vpTriangles))
+	, m_vpLines(std::move(other.m_vpLines))
+	, m_isTriangulated(other.m_isTriangulated)
+	, m_BoundsMin(other.m_BoundsMin)
+	, m_BoundsMax(other.m_BoundsMax)
+	, m_IsBoundsDirty(other.m_IsBoundsDirty)
+{
+	other.m_vpTriangles.clear();
+	other.m_vpLines.clear();
+	other.m_isTriangulated = false;
+	other.m_IsBoundsDirty = true;
+}
+
+Elite::Polygon& Elite::Polygon::operator=(const Polygon& other)
+{
+	if (this != &other)
+		*this = Polygon(other);
+	return *this;
+}
+
+Elite::Polygon& Elite::Polygon::operator=(Polygon&& other) noexcept
+{
+	if (this == &other)
+		return *this;
+
+	for (auto t : m_vpTriangles)
+		SAFE_DELETE(t);
+	for (auto l : m_vpLines)
+		SAFE_DELETE(l);
+
+	m_vChildren = std::move(other.m_vChildren);
+	m_vPoints = std::move(other.m_vPoints);
+	m_vpTriangles = std::move(other.m_vpTriangles);
+	m_vpLines = std::move(other.m_vpLines);
+	m_isTriangulated = other.m_isTriangulated;
+	m_BoundsMin = other.m_BoundsMin;
+	m_BoundsMax = other.m_BoundsMax;
+	m_IsBoundsDirty = other.m_IsBoundsDirty;
+
+	other.m_vpTriangles.clear();
+	other.m_vpLines.clear();
+	other.m_isTriangulated = false;
+	other.m_IsBoundsDirty = true;
+	return *this;
+}
 #pragma endregion //Constructors
 //----------------------------------------------------------
 #pragma region ChildFunctionality
 //=== Child functionality ===
 Elite::Polygon* Elite::Polygon::AddChild(std::list<Vector2>& vertices)
 {
-	const Polygon p(vertices);
-	m_vChildren.push_back(p);
+	m_vChildren.push_back(Polygon(vertices));
 	return &m_vChildren[m_vChildren.size() - 1];
 };
 
@@ -71,6 +142,11 @@ void Elite::Polygon::AddChild(const Polygon& p)
 	m_vChildren.push_back(p);
 }
 
+void Elite::Polygon::AddChild(Polygon&& p)
+{
+	m_vChildren.push_back(std::move(p));
+}
+
 void Elite::Polygon::RemoveChild(const Polygon& p)
 {
 	//Find if child is present
@@ -125,38 +201,36 @@ const std::vector<Elite::Line*>& Elite::Polygon::GetLines() const
 #pragma region GettersInformation
 float Elite::Polygon::GetPosVertMaxXPos() const
 {
-	//Go over all the verts of this polygon (not children) and get the position of the most right vertex
-	auto maxXPos = std::numeric_limits<float>::lowest();
-	for (const auto p : m_vPoints)
-		p.x > maxXPos ? maxXPos = p.x : 0;
-	return maxXPos;
+	//Position of the most right vertex of this polygon (not children)
+	UpdateBounds();
+	return m_BoundsMax.x;
 }
 
 float Elite::Polygon::GetPosVertMaxYPos() const
 {
-	//Go over all the verts of this polygon (not children) and get the position of the most top vertex
-	auto maxYPos = std::numeric_limits<float>::lowest();
-	for (const auto p : m_vPoints)
-		p.y > maxYPos ? maxYPos = p.y : 0;
-	return maxYPos;
+	//Position of the most top vertex of this polygon (not children)
+	UpdateBounds();
+	return m_BoundsMax.y;
 }
 
 float Elite::Polygon::GetPosVertMinXPos() const
 {
-	//Go over all the verts of this polygon (not children) and get the position of the most right vertex
-	auto minXPos = (std::numeric_limits<float>::max)();
-	for (const auto p : m_vPoints)
-		p.x < minXPos ? minXPos = p.x : 0;
-	return minXPos;
+	//Position of the most left vertex of this polygon (not children)
+	UpdateBounds();
+	return m_BoundsMin.x;
 }
 
 float Elite::Polygon::GetPosVertMinYPos() const
 {
-	//Go over all the verts of this polygon (not children) and get the position of the most top vertex
-	auto minYPos = (std::numeric_limits<float>::max)();
-	for (const auto p : m_vPoints)
-		p.y < minYPos ? minYPos = p.y : 0;
-	return minYPos;
+	//Position of the most bottom vertex of this polygon (not children)
+	UpdateBounds();
+	return m_BoundsMin.y;
+}
+
+Elite::Rect Elite::Polygon::GetBoundingBox() const
+{
+	UpdateBounds();
+	return Rect(m_BoundsMin, m_BoundsMax.x - m_BoundsMin.x, m_BoundsMax.y - m_BoundsMin.y);
 }
 
 bool Elite::Polygon::OverlappingXAxis(const Polygon& poly) const
@@ -270,70 +344,89 @@ const std::vector<const Elite::Triangle*> Elite::Polygon::GetTrianglesFromLineIn
 #pragma endregion //GettersInformation
 //----------------------------------------------------------
 #pragma region TriangulationFunctions
-const std::vector<Elite::Triangle*>& Elite::Polygon::Triangulate()
+const std::vector<Elite::Triangle*>& Elite::Polygon::Triangulate(TriangulationMode mode, float simplifyTolerance, WorkerPool* pPool)
 {
 	//Check winding
 	OrientateWithChildren(Winding::CCW);
 
-	//TODO: CHECK FOR OVERLAPPING POLYGONS AND MERGE WHEN REQUIRED
-	for (auto child : m_vChildren)
+	//Check for overlapping polygons, merge them into new children and remove the old ones
+	std::vector<Polygon> islands;
+	MergeOverlappingChildren(islands);
+
+	//Courtyards enclosed by merged children are not connected to this shape. With a pool they are triangulated
+	//on the workers while this thread does this shape (task 0), their triangles are added in order afterwards
+	const auto triangulate = [&](size_t i)
+	{
+		if (i == 0)
+			TriangulateShape(mode, simplifyTolerance);
+		else
+			islands[i - 1].Triangulate(mode, simplifyTolerance, pPool);
+	};
+	if (pPool != nullptr)
+		pPool->ParallelFor(islands.size() + 1, triangulate);
+	else
 	{
-		//Check for overlap, if so merge, create new child and remove old ones!
-		//FILL IN FUNCTIONS!
+		for (size_t i = 0; i <= islands.size(); ++i)
+			triangulate(i);
+	}
+	for (auto& island : islands)
+	{
+		m_vpTriangles.insert(m_vpTriangles.end(), island.m_vpTriangles.begin(), island.m_vpTriangles.end());
+		island.m_vpTriangles.clear();
 	}
 
-	//Sort the children. Start by sorting from top to bottom (verices are what matters, not the "center" pos of the polygon!)
-	std::sort(m_vChildren.begin(), m_vChildren.end(),
-		[](const Polygon& p1, const Polygon& p2)
-		{
-			return p1.GetPosVertMaxYPos() > p2.GetPosVertMaxYPos();
-		});
-
-	//Copy children as backup after sort
-	const auto children = m_vChildren;
-
+	//Flag as triangulated for later use
+	m_isTriangulated = true;
 
-	//THEN, we check two elements, if the don't overlap horizontally you don't do anything, else you swap them based on right most object
-	for (int i = 0; i < int(m_vChildren.size()) - 1; ++i)
-	{
-		for (int j = i + 1; j < int(m_vChildren.size()); ++j)
-		{
-			if (m_vChildren[i].OverlappingYAxis(m_vChildren[j]) || m_vChildren[i].GetPosVertMaxYPos() < m_vChildren[j].GetPosVertMaxYPos())
-			{
-				//Swap if i.y < i+1.y
-				if (m_vChildren[i].GetPosVertMaxXPos() < m_vChildren[j].GetPosVertMaxXPos() )
-				{
-					const auto temp = m_vChildren[i];
-					m_vChildren[i] = m_vChildren[j];
-					m_vChildren[j] = temp;
-				}
-			}
-		}
+#ifdef USE_TRIANGLE_METADATA
+	GenerateLineMatrix();
+#endif
 
-	}
-	//First split polygon
-	while (m_vChildren.size() != 0)
-		Split();
+	return m_vpTriangles;
+}
 
-	//Triangle list - Clear first (if already containing triangles)
+void Elite::Polygon::TriangulateShape(TriangulationMode mode, float simplifyTolerance)
+{
+	//Optionally get rid of vertices that don't add anything (the merged outlines and expanded shapes tend to have those)
+	if (simplifyTolerance > 0.f)
+		Simplify(simplifyTolerance);
+
+	//First split polygon, the children themselves are left untouched (Split bridges them in the right order itself)
+	std::vector<const Polygon*> holes;
+	holes.reserve(m_vChildren.size());
+	for (const auto& child : m_vChildren)
+		holes.push_back(&child);
+	while (holes.size() != 0)
+		Split(holes);
+
+	//Triangle and line list - Clear first (if already containing triangles)
 	for (auto t : m_vpTriangles)
 		SAFE_DELETE(t);
 	m_vpTriangles.clear();
+	for (auto l : m_vpLines)
+		SAFE_DELETE(l);
+	m_vpLines.clear();
 
 	std::list<Vector2> copyPoints;
 	copyPoints.assign(m_vPoints.begin(), m_vPoints.end()); //Copy
+	m_vpTriangles.reserve(copyPoints.size() - 2); //A simple polygon with n vertices has n - 2 triangles
 
 	//For each ear, remove ear and push verts, recheck earness (including convexness obviously :-))!
+	//The search continues at the neighbour of the last ear instead of restarting at the front, only the neighbours change.
+	auto searchStart = copyPoints.cbegin();
 	while (copyPoints.size() > 3)
 	{
 		list<Vector2>::const_iterator earListIt = copyPoints.end();
-		for (auto it = copyPoints.begin(); it != copyPoints.end(); ++it)
+		auto it = searchStart;
+		for (size_t i = 0; i < copyPoints.size(); ++i)
 		{
 			if (IsConvexInPolygon(copyPoints, it) && IsEar(copyPoints, it))
 			{ 
 				earListIt = it;
 				break;
 			}
+			if (++it == copyPoints.cend())
+				it = copyPoints.cbegin();
 		}
 		
 		if (earListIt == copyPoints.end())
@@ -348,26 +441,19 @@ const std::vector<Elite::Triangle*>& Elite::Polygon::Triangulate()
 		Triangle* t = new Triangle(prev, current, next);
 		m_vpTriangles.push_back(t);
 
-		//Remove current from pointslist
-		const auto currentIt = std::find(copyPoints.begin(), copyPoints.end(), current);
-		copyPoints.erase(currentIt); //remove
+		//Remove current from pointslist (the iterator itself, bridged vertices are in the list twice)
+		searchStart = earListIt == copyPoints.cbegin() ? std::prev(copyPoints.cend()) : std::prev(earListIt);
+		copyPoints.erase(earListIt); //remove
 	}
 	//Add the remaining 3 vertices to the triangulated polygon
-	std::vector<Vector2> tempCopy;
-	for (const auto p : copyPoints)
-		tempCopy.push_back(p);
-	Triangle* lastTriangle = new Triangle(tempCopy[0], tempCopy[1], tempCopy[2]);
+	auto itLast = copyPoints.cbegin();
+	const auto& last1 = *itLast++;
+	const auto& last2 = *itLast++;
+	Triangle* lastTriangle = new Triangle(last1, last2, *itLast);
 	m_vpTriangles.push_back(lastTriangle);
 
-	//Flag as triangulated for later use
-	m_isTriangulated = true;
-
-#ifdef USE_TRIANGLE_METADATA
-	GenerateLineMatrix();
-#endif
-
-	m_vChildren = children;
-	return m_vpTriangles;
+	if (mode == TriangulationMode::ConstrainedDelaunay)
+		MakeConstrainedDelaunay();
 }
 
 void Elite::Polygon::OrientateWithChildren(Winding winding)
@@ -380,18 +466,24 @@ void Elite::Polygon::OrientateWithChildren(Winding winding)
 
 	//Rewind the children if necessary
 	auto windingChildren = abs(winding - 1); //CCW -> CW, CW -> CCW ----- abs(0-1)=1, abs(1-1)=0
-	for (auto child : m_vChildren)
+	for (auto& child : m_vChildren)
 		child.OrientateWithChildren(static_cast<Winding>(windingChildren));
 }
 
 void Elite::Polygon::ExpandShape(float amount)
 {
-	//Expand each vertex along it's normal (based on adjacent edges)
-	std::list<Vector2> adjustedPoints;
+	if (m_vPoints.size() < 3)
+		return;
+
+	//Expand each vertex along it's normal (based on adjacent edges). The points are moved in place,
+	//so the original previous and first point are remembered
+	auto prev = m_vPoints.back();
+	const auto first = m_vPoints.front();
 	for (auto it = m_vPoints.begin(); it != m_vPoints.end(); ++it)
 	{
-		Vector2 current, prev, next;
-		GetTriangle(m_vPoints, it, current, prev, next);
+		const auto current = *it;
+		const auto nextIt = std::next(it);
+		const auto next = nextIt == m_vPoints.end() ? first : *nextIt;
 		//Calculate directions
 		auto dirOne = current - prev;
 		auto dirTwo = next - current;
@@ -412,13 +504,542 @@ void Elite::Polygon::ExpandShape(float amount)
 		fnorm *= size;
 
 		//Displace
-		adjustedPoints.push_back(*it + fnorm);
+		*it += fnorm;
+		prev = current;
 	}
-	//Overwrite data
-	m_vPoints = adjustedPoints;
+	InvalidateBounds();
+}
+
+namespace
+{
+	//=== Helpers to simplify outlines ===
+	void SimplifyChain(const std::vector<Elite::Vector2>& points, size_t first, size_t last, float toleranceSquared, std::vector<bool>& keep)
+	{
+		//Douglas-Peucker, keep the point furthest from the line first-last if it's further than the tolerance and recurse on both halves
+		std::vector<std::pair<size_t, size_t>> ranges{ { first, last } };
+		while (!ranges.empty())
+		{
+			const auto range = ranges.back();
+			ranges.pop_back();
+
+			const auto& start = points[range.first];
+			const auto& end = points[range.second % points.size()];
+			float furthestSquared = -1.f;
+			size_t furthest = range.first;
+			for (auto i = range.first + 1; i < range.second; ++i)
+			{
+				const auto& p = points[i];
+				const auto dir = end - start;
+				const auto lengthSquared = Elite::Dot(dir, dir);
+				const auto t = lengthSquared > 0.f ? Elite::Clamp(Elite::Dot(p - start, dir) / lengthSquared, 0.f, 1.f) : 0.f;
+				const auto distanceSquared = Elite::DistanceSquared(start + t * dir, p);
+				if (distanceSquared > furthestSquared)
+				{
+					furthestSquared = distanceSquared;
+					furthest = i;
+				}
+			}
+
+			if (furthestSquared > toleranceSquared)
+			{
+				keep[furthest] = true;
+				ranges.push_back({ range.first, furthest });
+				ranges.push_back({ furthest, range.second });
+			}
+		}
+	}
+
+	std::vector<Elite::Vector2> SimplifyRing(const std::vector<Elite::Vector2>& ring, float tolerance)
+	{
+		//Drop near duplicates first, then run Douglas-Peucker on the two halves of the ring,
+		//split at the point furthest from the first one
+		const auto toleranceSquared = tolerance * tolerance;
+		std::vector<Elite::Vector2> points;
+		points.reserve(ring.size());
+		for (const auto& p : ring)
+		{
+			if (points.empty() || Elite::DistanceSquared(points.back(), p) > toleranceSquared)
+				points.push_back(p);
+		}
+		while (points.size() > 1 && Elite::DistanceSquared(points.back(), points.front()) <= toleranceSquared)
+			points.pop_back();
+		if (points.size() < 3)
+			return ring;
+
+		size_t split = 1;
+		for (size_t i = 2; i < points.size(); ++i)
+		{
+			if (Elite::DistanceSquared(points[i], points[0]) > Elite::DistanceSquared(points[split], points[0]))
+				split = i;
+		}
+
+		std::vector<bool> keep(points.size(), false);
+		keep[0] = keep[split] = true;
+		SimplifyChain(points, 0, split, toleranceSquared, keep);
+		SimplifyChain(points, split, points.size(), toleranceSquared, keep);
+
+		std::vector<Elite::Vector2> simplified;
+		for (size_t i = 0; i < points.size(); ++i)
+		{
+			if (keep[i])
+				simplified.push_back(points[i]);
+		}
+		return simplified.size() >= 3 ? simplified : ring;
+	}
+
+	bool SegmentsCross(const Elite::Vector2& p1, const Elite::Vector2& p2, const Elite::Vector2& q1, const Elite::Vector2& q2)
+	{
+		//Proper crossings only, segments sharing an end point are fine
+		if (p1 == q1 || p1 == q2 || p2 == q1 || p2 == q2)
+			return false;
+		const auto d1 = Elite::Cross(p2 - p1, q1 - p1);
+		const auto d2 = Elite::Cross(p2 - p1, q2 - p1);
+		const auto d3 = Elite::Cross(q2 - q1, p1 - q1);
+		const auto d4 = Elite::Cross(q2 - q1, p2 - q1);
+		return ((d1 > 0.f && d2 < 0.f) || (d1 < 0.f && d2 > 0.f)) && ((d3 > 0.f && d4 < 0.f) || (d3 < 0.f && d4 > 0.f));
+	}
+
+	bool RingsCross(const std::vector<Elite::Vector2>& a, const std::vector<Elite::Vector2>& b)
+	{
+		//Also used with a == b, neighbouring edges share a point so they don't count
+		for (size_t i = 0; i < a.size(); ++i)
+		{
+			for (size_t j = 0; j < b.size(); ++j)
+			{
+				if (SegmentsCross(a[i], a[(i + 1) % a.size()], b[j], b[(j + 1) % b.size()]))
+					return true;
+			}
+		}
+		return false;
+	}
+}
+
+int Elite::Polygon::Simplify(float tolerance)
+{
+	//Ring 0 is this shape, the others are the children
+	std::vector<std::vector<Vector2>> originals;
+	originals.reserve(m_vChildren.size() + 1);
+	originals.push_back(std::vector<Vector2>(m_vPoints.begin(), m_vPoints.end()));
+	for (const auto& child : m_vChildren)
+		originals.push_back(std::vector<Vector2>(child.m_vPoints.begin(), child.m_vPoints.end()));
+
+	std::vector<std::vector<Vector2>> rings;
+	rings.reserve(originals.size());
+	for (const auto& ring : originals)
+	{
+		auto simplified = SimplifyRing(ring, tolerance);
+		//A simplified ring can't intersect itself or flip
+		if (simplified.size() != ring.size() && (RingsCross(simplified, simplified) || GetPolygonWinding(simplified) != GetPolygonWinding(ring)))
+			simplified = ring;
+		rings.push_back(std::move(simplified));
+	}
+
+	//Changed rings can't cross other rings either, only the rings with overlapping bounds need to be checked
+	std::vector<Rect> bounds;
+	bounds.reserve(rings.size());
+	for (const auto& ring : rings)
+	{
+		Vector2 minPoint = ring.front(), maxPoint = ring.front();
+		for (const auto& p : ring)
+		{
+			minPoint = Vector2(min(minPoint.x, p.x), min(minPoint.y, p.y));
+			maxPoint = Vector2(max(maxPoint.x, p.x), max(maxPoint.y, p.y));
+		}
+		bounds.push_back(Rect(minPoint - Vector2(tolerance, tolerance), maxPoint.x - minPoint.x + 2.f * tolerance, maxPoint.y - minPoint.y + 2.f * tolerance));
+	}
+	//The outer shape contains all the others, so it's tested against every ring
+	//Putting a ring back can make it cross another simplified one, so repeat until nothing changes
+	std::vector<std::pair<int, int>> pairs;
+	GetOverlappingPairs(bounds, pairs);
+	auto isRestored = true;
+	while (isRestored)
+	{
+		isRestored = false;
+		for (const auto& pair : pairs)
+		{
+			auto& a = rings[pair.first];
+			auto& b = rings[pair.second];
+			const auto changed = a.size() != originals[pair.first].size() || b.size() != originals[pair.second].size();
+			if (changed && RingsCross(a, b))
+			{
+				a = originals[pair.first];
+				b = originals[pair.second];
+				isRestored = true;
+			}
+		}
+	}
+
+	//Write back
+	int removed = 0;
+	for (size_t i = 0; i < rings.size(); ++i)
+	{
+		removed += static_cast<int>(originals[i].size() - rings[i].size());
+		auto& points = i == 0 ? m_vPoints : m_vChildren[i - 1].m_vPoints;
+		points.assign(rings[i].begin(), rings[i].end());
+		if (i == 0)
+			InvalidateBounds();
+		else
+			m_vChildren[i - 1].InvalidateBounds();
+	}
+	return removed;
 }
 #pragma endregion //TriangulationFunctions
 //----------------------------------------------------------
+#pragma region TriangulationCache
+namespace
+{
+	//=== Cache file layout ===
+	//The file is a list of entries, every entry is a header followed by the points, triangles and lines
+	constexpr uint32_t CacheMagic = 0x31435445; //"ETC1"
+	constexpr uint32_t CacheVersion = 1;
+	constexpr size_t MaxCacheFileSize = 16 * 1024 * 1024; //Least recently used entries that don't fit are dropped on Save
+	constexpr size_t MaxCacheEntries = 64; //In memory and in the file, the least recently used one makes room for a new one
+
+	struct CacheHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t key;
+		uint32_t pointCount;
+		uint32_t triangleCount;
+		uint32_t lineCount;
+		uint32_t padding;
+	};
+	struct CacheTriangle
+	{
+		float points[6];
+		int32_t lineIndices[3];
+	};
+	struct CacheLine
+	{
+		float points[4];
+		int32_t index;
+	};
+	static_assert(sizeof(CacheHeader) == 32 && sizeof(CacheTriangle) == 36 && sizeof(CacheLine) == 20, "Cache layout changed, bump CacheVersion");
+
+	size_t GetEntrySize(const CacheHeader& header)
+	{
+		return sizeof(CacheHeader) + header.pointCount * sizeof(float) * 2
+			+ header.triangleCount * sizeof(CacheTriangle) + header.lineCount * sizeof(CacheLine);
+	}
+
+	uint64_t HashBytes(uint64_t hash, const void* pData, size_t size)
+	{
+		//FNV-1a
+		const auto pBytes = static_cast<const unsigned char*>(pData);
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash ^= pBytes[i];
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	//Read only view of a whole file
+	class MappedFile final
+	{
+	public:
+		explicit MappedFile(const std::string& filePath)
+		{
+#ifdef _WIN32
+			m_File = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (m_File == INVALID_HANDLE_VALUE)
+				return;
+			LARGE_INTEGER size{};
+			if (!GetFileSizeEx(m_File, &size) || size.QuadPart == 0)
+				return;
+			m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (m_Mapping == nullptr)
+				return;
+			m_pData = static_cast<const char*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+			if (m_pData != nullptr)
+				m_Size = static_cast<size_t>(size.QuadPart);
+#else
+			m_File = open(filePath.c_str(), O_RDONLY);
+			if (m_File < 0)
+				return;
+			struct stat fileStat {};
+			if (fstat(m_File, &fileStat) != 0 || fileStat.st_size == 0)
+				return;
+			const auto pData = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, m_File, 0);
+			if (pData == MAP_FAILED)
+				return;
+			m_pData = static_cast<const char*>(pData);
+			m_Size = static_cast<size_t>(fileStat.st_size);
+#endif
+		}
+		~MappedFile()
+		{
+#ifdef _WIN32
+			if (m_pData != nullptr)
+				UnmapViewOfFile(m_pData);
+			if (m_Mapping != nullptr)
+				CloseHandle(m_Mapping);
+			if (m_File != INVALID_HANDLE_VALUE)
+				CloseHandle(m_File);
+#else
+			if (m_pData != nullptr)
+				munmap(const_cast<char*>(m_pData), m_Size);
+			if (m_File >= 0)
+				close(m_File);
+#endif
+		}
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		const char* GetData() const { return m_pData; }
+		size_t GetSize() const { return m_Size; }
+
+	private:
+#ifdef _WIN32
+		HANDLE m_File = INVALID_HANDLE_VALUE;
+		HANDLE m_Mapping = nullptr;
+#else
+		int m_File = -1;
+#endif
+		const char* m_pData = nullptr;
+		size_t m_Size = 0;
+	};
+}
+
+uint64_t Elite::Polygon::GetContentHash() const
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	const auto pointCount = static_cast<uint32_t>(m_vPoints.size());
+	hash = HashBytes(hash, &pointCount, sizeof(pointCount));
+	for (const auto& p : m_vPoints)
+		hash = HashBytes(hash, &p, sizeof(Vector2));
+
+	//The children are in the order they were added (the order the houses were found in),
+	//sorting their hashes gives the same key for the same set of children
+	std::vector<uint64_t> childHashes;
+	childHashes.reserve(m_vChildren.size());
+	for (const auto& child : m_vChildren)
+		childHashes.push_back(child.GetContentHash());
+	std::sort(childHashes.begin(), childHashes.end());
+
+	const auto childCount = static_cast<uint32_t>(childHashes.size());
+	hash = HashBytes(hash, &childCount, sizeof(childCount));
+	for (const auto childHash : childHashes)
+		hash = HashBytes(hash, &childHash, sizeof(childHash));
+	return hash;
+}
+
+bool Elite::Polygon::ReadTriangulationCache(TriangulationCache& cache, uint64_t key)
+{
+	const auto pEntry = cache.Find(key);
+	if (pEntry == nullptr)
+		return false;
+	const auto pData = pEntry->data();
+
+	//The size of the entry was checked when the cache was loaded
+	CacheHeader header;
+	memcpy(&header, pData, sizeof(CacheHeader));
+	if (header.pointCount < 3 || header.triangleCount == 0)
+		return false;
+
+	//Validate before touching the polygon
+	auto pCurrent = pData + sizeof(CacheHeader);
+	const auto pPoints = pCurrent;
+	pCurrent += header.pointCount * sizeof(float) * 2;
+	const auto pTriangles = pCurrent;
+	pCurrent += header.triangleCount * sizeof(CacheTriangle);
+	const auto pLines = pCurrent;
+	for (uint32_t i = 0; i < header.triangleCount; ++i)
+	{
+		CacheTriangle triangle;
+		memcpy(&triangle, pTriangles + i * sizeof(CacheTriangle), sizeof(CacheTriangle));
+		for (const auto lineIndex : triangle.lineIndices)
+		{
+			if (lineIndex < -1 || lineIndex >= static_cast<int32_t>(header.lineCount))
+				return false;
+		}
+	}
+
+	//Clear first (if already containing triangles)
+	for (auto t : m_vpTriangles)
+		SAFE_DELETE(t);
+	m_vpTriangles.clear();
+	for (auto l : m_vpLines)
+		SAFE_DELETE(l);
+	m_vpLines.clear();
+
+	//The points are the outline after bridging the holes, like after Triangulate
+	m_vPoints.clear();
+	for (uint32_t i = 0; i < header.pointCount; ++i)
+	{
+		Vector2 point;
+		memcpy(&point, pPoints + i * sizeof(float) * 2, sizeof(float) * 2);
+		m_vPoints.push_back(point);
+	}
+	InvalidateBounds();
+
+	m_vpTriangles.reserve(header.triangleCount);
+	for (uint32_t i = 0; i < header.triangleCount; ++i)
+	{
+		CacheTriangle triangle;
+		memcpy(&triangle, pTriangles + i * sizeof(CacheTriangle), sizeof(CacheTriangle));
+		const auto t = new Triangle({ triangle.points[0], triangle.points[1] }, { triangle.points[2], triangle.points[3] }, { triangle.points[4], triangle.points[5] });
+#ifdef USE_TRIANGLE_METADATA
+		t->metaData.IndexLines = { { triangle.lineIndices[0], triangle.lineIndices[1], triangle.lineIndices[2] } };
+#endif
+		m_vpTriangles.push_back(t);
+	}
+
+	m_vpLines.reserve(header.lineCount);
+	for (uint32_t i = 0; i < header.lineCount; ++i)
+	{
+		CacheLine line;
+		memcpy(&line, pLines + i * sizeof(CacheLine), sizeof(CacheLine));
+		m_vpLines.push_back(new Line({ line.points[0], line.points[1] }, { line.points[2], line.points[3] }, static_cast<int>(i)));
+	}
+
+	m_isTriangulated = true;
+	return true;
+}
+
+bool Elite::Polygon::WriteTriangulationCache(TriangulationCache& cache, uint64_t key) const
+{
+	if (!m_isTriangulated)
+		return false;
+
+	CacheHeader header{};
+	header.magic = CacheMagic;
+	header.version = CacheVersion;
+	header.key = key;
+	header.pointCount = static_cast<uint32_t>(m_vPoints.size());
+	header.triangleCount = static_cast<uint32_t>(m_vpTriangles.size());
+	header.lineCount = static_cast<uint32_t>(m_vpLines.size());
+
+	std::vector<char> entry(GetEntrySize(header));
+	auto pCurrent = entry.data();
+	memcpy(pCurrent, &header, sizeof(CacheHeader));
+	pCurrent += sizeof(CacheHeader);
+	for (const auto& p : m_vPoints)
+	{
+		const float point[2] = { p.x, p.y };
+		memcpy(pCurrent, point, sizeof(point));
+		pCurrent += sizeof(point);
+	}
+	for (const auto t : m_vpTriangles)
+	{
+		CacheTriangle triangle{ { t->p1.x, t->p1.y, t->p2.x, t->p2.y, t->p3.x, t->p3.y }, { -1, -1, -1 } };
+#ifdef USE_TRIANGLE_METADATA
+		for (int i = 0; i < 3; ++i)
+			triangle.lineIndices[i] = t->metaData.IndexLines[i];
+#endif
+		memcpy(pCurrent, &triangle, sizeof(CacheTriangle));
+		pCurrent += sizeof(CacheTriangle);
+	}
+	for (const auto l : m_vpLines)
+	{
+		const CacheLine line{ { l->p1.x, l->p1.y, l->p2.x, l->p2.y }, l->index };
+		memcpy(pCurrent, &line, sizeof(CacheLine));
+		pCurrent += sizeof(CacheLine);
+	}
+
+	cache.Add(key, std::move(entry));
+	return true;
+}
+
+bool Elite::TriangulationCache::Load(const std::string& filePath)
+{
+	m_Entries.clear();
+	m_UseCount = 0;
+	m_IsModified = false;
+
+	const MappedFile file{ filePath };
+	const auto pData = file.GetData();
+	const auto size = file.GetSize();
+
+	//Keep every entry up to anything that doesn't look like one (other version, cut off, ...)
+	size_t offset = 0;
+	while (offset + sizeof(CacheHeader) <= size && m_Entries.size() < MaxCacheEntries)
+	{
+		CacheHeader header;
+		memcpy(&header, pData + offset, sizeof(CacheHeader));
+		if (header.magic != CacheMagic || header.version != CacheVersion)
+			break;
+		const auto entrySize = GetEntrySize(header);
+		if (offset + entrySize > size)
+			break;
+		m_Entries.push_back({ header.key, 0, std::vector<char>(pData + offset, pData + offset + entrySize) });
+		offset += entrySize;
+	}
+	//A file that held more than that gets rewritten on Save
+	m_IsModified = offset != size;
+
+	//Save writes the most recently used first, keep that order
+	m_UseCount = m_Entries.size();
+	for (size_t i = 0; i < m_Entries.size(); ++i)
+		m_Entries[i].lastUse = m_UseCount - i;
+	return !m_Entries.empty();
+}
+
+bool Elite::TriangulationCache::Save(const std::string& filePath) const
+{
+	if (!m_IsModified)
+		return true;
+
+	std::vector<const Entry*> order;
+	order.reserve(m_Entries.size());
+	for (const auto& entry : m_Entries)
+		order.push_back(&entry);
+	std::sort(order.begin(), order.end(), [](const Entry* pA, const Entry* pB) { return pA->lastUse > pB->lastUse; });
+
+	std::ofstream file{ filePath, std::ios::binary | std::ios::trunc };
+	if (!file)
+	{
+		printf("\n--Could not write triangulation cache %s!\n", filePath.c_str());
+		return false;
+	}
+	size_t fileSize = 0;
+	for (const auto pEntry : order)
+	{
+		fileSize += pEntry->data.size();
+		if (fileSize > MaxCacheFileSize)
+			break;
+		file.write(pEntry->data.data(), pEntry->data.size());
+	}
+	return file.good();
+}
+
+const std::vector<char>* Elite::TriangulationCache::Find(uint64_t key)
+{
+	for (auto& entry : m_Entries)
+	{
+		if (entry.key != key)
+			continue;
+		entry.lastUse = ++m_UseCount;
+		m_IsModified = true;
+		return &entry.data;
+	}
+	return nullptr;
+}
+
+void Elite::TriangulationCache::Add(uint64_t key, std::vector<char>&& data)
+{
+	m_IsModified = true;
+	for (auto& entry : m_Entries)
+	{
+		if (entry.key != key)
+			continue;
+		entry.lastUse = ++m_UseCount;
+		entry.data = std::move(data);
+		return;
+	}
+
+	//Full, the least recently used one makes room
+	if (m_Entries.size() >= MaxCacheEntries)
+	{
+		const auto leastUsed = std::min_element(m_Entries.begin(), m_Entries.end(),
+			[](const Entry& a, const Entry& b) { return a.lastUse < b.lastUse; });
+		m_Entries.erase(leastUsed);
+	}
+	m_Entries.push_back({ key, ++m_UseCount, std::move(data) });
+}
+#pragma endregion //TriangulationCache
+//----------------------------------------------------------
 #pragma region PrivateGeneralFunctions
 void Elite::Polygon::GetTriangle(const list<Vector2>& l, const list<Vector2>::const_iterator p, Vector2& currentTip, Vector2& previous, Vector2& next) const
 {
@@ -465,247 +1086,883 @@ bool Elite::Polygon::IsEar(const list<Vector2>& l, const list<Vector2>::const_it
 	return true;
 }
 
+void Elite::Polygon::UpdateBounds() const
+{
+	if (!m_IsBoundsDirty)
+		return;
+
+	//Go over all the verts of this polygon (not children) once for all four sides
+	m_BoundsMin = Vector2((std::numeric_limits<float>::max)(), (std::numeric_limits<float>::max)());
+	m_BoundsMax = Vector2(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest());
+	for (const auto& p : m_vPoints)
+	{
+		p.x < m_BoundsMin.x ? m_BoundsMin.x = p.x : 0;
+		p.y < m_BoundsMin.y ? m_BoundsMin.y = p.y : 0;
+		p.x > m_BoundsMax.x ? m_BoundsMax.x = p.x : 0;
+		p.y > m_BoundsMax.y ? m_BoundsMax.y = p.y : 0;
+	}
+	m_IsBoundsDirty = false;
+}
+
 void Elite::Polygon::GenerateLineMatrix()
 {
 #ifdef USE_TRIANGLE_METADATA
-	//Go over all the triangles
-	for (auto t : m_vpTriangles)
+	//Every triangle edge gets a slot (triangle * 3 + edge), slots with the same (sorted) end points share a line.
+	//Sorting the slots finds the shared edges without going over all the lines, and without a node per line like a map.
+	using LineKey = std::pair<std::pair<float, float>, std::pair<float, float>>;
+	const auto getKey = [](const Vector2& p1, const Vector2& p2)
 	{
-		//Go over all the lines of the triangle, search if they are already in the matrix
-		//If not add them and store it's index in the triangles meta data
-		const Line l1{ t->p1, t->p2 };
-		const Line l1rev{ t->p2, t->p1 };
-		const Line l2{ t->p2, t->p3 };
-		const Line l2rev{ t->p3, t->p2 };
-		const Line l3{ t->p3, t->p1 };
-		const Line l3rev{ t->p1, t->p3 };
-		for (auto i = 0; i < static_cast<int>(m_vpLines.size()); ++i)
-		{
-			const auto l = m_vpLines[i];
-			if (*l == l1 || *l == l1rev)
-				t->metaData.IndexLines[0] = i;
-			if (*l == l2 || *l == l2rev)
-				t->metaData.IndexLines[1] = i;
-			if (*l == l3 || *l == l3rev)
-				t->metaData.IndexLines[2] = i;
-		}
-		//Not found, add to matrix
-		if (t->metaData.IndexLines[0] == -1)
-		{
-			const int index = m_vpLines.size();
-			m_vpLines.push_back(new Line(t->p1, t->p2, index));
-			t->metaData.IndexLines[0] = index;
-		}
-		if (t->metaData.IndexLines[1] == -1)
+		const auto k1 = std::make_pair(p1.x, p1.y);
+		const auto k2 = std::make_pair(p2.x, p2.y);
+		return k1 < k2 ? LineKey(k1, k2) : LineKey(k2, k1);
+	};
+	const auto getPoint = [this](int slot, int offset) -> const Vector2&
+	{
+		const auto t = m_vpTriangles[slot / 3];
+		switch ((slot + offset) % 3)
 		{
-			const int index = m_vpLines.size();
-			m_vpLines.push_back(new Line(t->p2, t->p3, index));
-			t->metaData.IndexLines[1] = index;
+		case 0: return t->p1;
+		case 1: return t->p2;
+		default: return t->p3;
 		}
-		if (t->metaData.IndexLines[2] == -1)
+	};
+
+	const int slotCount = static_cast<int>(m_vpTriangles.size()) * 3;
+	std::vector<std::pair<LineKey, int>> slots;
+	slots.reserve(slotCount);
+	for (int slot = 0; slot < slotCount; ++slot)
+		slots.push_back({ getKey(getPoint(slot, 0), getPoint(slot, 1)), slot });
+	std::sort(slots.begin(), slots.end());
+
+	//First slot (in triangle order) of every line
+	std::vector<int> firstSlot(slotCount);
+	for (size_t i = 0; i < slots.size(); ++i)
+		firstSlot[slots[i].second] = (i > 0 && slots[i - 1].first == slots[i].first) ? firstSlot[slots[i - 1].second] : slots[i].second;
+
+	//Go over all the lines of all the triangles, if it's the first time we see the line add it to the matrix
+	//and store it's index in the triangles meta data
+	std::vector<int> lineIndices(slotCount, -1);
+	m_vpLines.reserve(m_vpLines.size() + slotCount / 2 + 2);
+	for (int slot = 0; slot < slotCount; ++slot)
+	{
+		if (firstSlot[slot] == slot)
 		{
-			const int index = m_vpLines.size();
-			m_vpLines.push_back(new Line(t->p3, t->p1, index));
-			t->metaData.IndexLines[2] = index;
+			lineIndices[slot] = static_cast<int>(m_vpLines.size());
+			m_vpLines.push_back(new Line(getPoint(slot, 0), getPoint(slot, 1), lineIndices[slot]));
 		}
+		m_vpTriangles[slot / 3]->metaData.IndexLines[slot % 3] = lineIndices[firstSlot[slot]];
 	}
 #endif
 }
 #pragma endregion //PrivateGeneralFunctions
 //----------------------------------------------------------
 #pragma region PrivateTriangulationFunctions
-void Elite::Polygon::FindMutualVisibleVertices(const Polygon& outer, const Polygon& inner, std::list<Vector2>::const_iterator& pOuter, std::list<Vector2>::const_iterator& pInner)
+//Uniform grid over the outer shape, used while bridging the holes. Edges are stored in every cell their bounding box
+//touches, vertices in the cell they are in. Entries are list iterators so the grid stays valid while holes get inserted.
+struct Elite::Polygon::BridgeGrid final
 {
-	//1. Find vertex with the biggest x value of the inner polygon AND biggest x value of outer polygon (used for size ray)
-	const auto maxInnerPoint = std::max_element(inner.m_vPoints.begin(), inner.m_vPoints.end(),
-		[](const Vector2& p1, const Vector2& p2) { return p1.x < p2.x; });
+	using Iterator = std::list<Vector2>::const_iterator;
 
-	const auto maxOuterPoint = std::max_element(outer.m_vPoints.begin(), outer.m_vPoints.end(),
-		[](const Vector2& p1, const Vector2& p2) { return p1.x < p2.x; });
-	const float rayMaxX = maxOuterPoint->x;
+	BridgeGrid(const std::list<Vector2>& points, size_t expectedVertices)
+		: pPoints(&points)
+	{
+		Vector2 minPoint = points.front(), maxPoint = points.front();
+		for (const auto& p : points)
+		{
+			minPoint = Vector2(min(minPoint.x, p.x), min(minPoint.y, p.y));
+			maxPoint = Vector2(max(maxPoint.x, p.x), max(maxPoint.y, p.y));
+		}
 
-	//Store inner point to output
-	pInner = maxInnerPoint;
-	// --- 2. Based on found inner point, find mutually visisble outer point
-	//2.1 Intersect ray M + t(1,0) with all directed edges of OUTER (M is left of edges) - Result point I
-	//http://stackoverflow.com/questions/563198/how-do-you-detect-where-two-line-segments-intersect
-	const Vector2 furthestPointRay = Vector2(rayMaxX, maxInnerPoint->y);
-	Vector2 p = *pInner;
-	Vector2 r = furthestPointRay - *pInner; //Ray
-	Vector2 I = ZeroVector2; //Found intersection
+		//Roughly one vertex per cell
+		const auto size = maxPoint - minPoint;
+		cellSize = max(sqrtf(max(size.x * size.y, 1.f) / static_cast<float>(max(expectedVertices, size_t(1)))), 0.01f);
+		columns = Clamp(static_cast<int>(size.x / cellSize) + 1, 1, 256);
+		rows = Clamp(static_cast<int>(size.y / cellSize) + 1, 1, 256);
+		cellSize = max(size.x / columns, size.y / rows) + 0.01f;
+		origin = minPoint;
+		edgeCells.resize(columns * rows, -1);
+		vertexCells.resize(columns * rows, -1);
+		edgeNodes.reserve(expectedVertices * 2);
+		vertexNodes.reserve(expectedVertices);
+
+		for (auto it = points.begin(); it != points.end(); ++it)
+		{
+			AddEdge(it);
+			AddVertex(it);
+		}
+	}
 
-	std::list<Vector2>::const_iterator intersectedLine[2] = { outer.m_vPoints.end(), outer.m_vPoints.end() }; //Store to find point P if I is found
-	std::list<Vector2>::const_iterator nearestIt{ outer.m_vPoints.end() };
+	Iterator Next(Iterator it) const
+	{
+		++it;
+		return it == pPoints->end() ? pPoints->begin() : it;
+	}
+	int GetColumn(float x) const { return Clamp(static_cast<int>((x - origin.x) / cellSize), 0, columns - 1); }
+	int GetRow(float y) const { return Clamp(static_cast<int>((y - origin.y) / cellSize), 0, rows - 1); }
 
-	for (auto it = outer.m_vPoints.begin(); it != outer.m_vPoints.end(); ++it)
+	//Edge from it to the next point
+	void AddEdge(Iterator it)
 	{
-		const auto next = std::next(it);
-		//If on right of innerPoint AND has a next point (to make line)
-		if (it->x > maxInnerPoint->x && next != outer.m_vPoints.end())
-		{
+		const auto& p1 = *it;
+		const auto& p2 = *Next(it);
+		const auto maxColumn = GetColumn(max(p1.x, p2.x));
+		const auto maxRow = GetRow(max(p1.y, p2.y));
+		for (auto row = GetRow(min(p1.y, p2.y)); row <= maxRow; ++row)
+			for (auto column = GetColumn(min(p1.x, p2.x)); column <= maxColumn; ++column)
+				Push(edgeCells[row * columns + column], edgeNodes, it);
+	}
+	void AddVertex(Iterator it)
+	{
+		Push(vertexCells[GetRow(it->y) * columns + GetColumn(it->x)], vertexNodes, it);
+	}
+	static void Push(int& head, std::vector<std::pair<Iterator, int>>& nodes, Iterator it)
+	{
+		nodes.push_back({ it, head });
+		head = static_cast<int>(nodes.size()) - 1;
+	}
 
+	const std::list<Vector2>* pPoints = nullptr;
+	//Every cell is a linked list in one node vector (iterator, next node), no allocations per cell
+	std::vector<int> edgeCells;
+	std::vector<int> vertexCells;
+	std::vector<std::pair<Iterator, int>> edgeNodes;
+	std::vector<std::pair<Iterator, int>> vertexNodes;
+	Vector2 origin = {};
+	float cellSize = 1.f;
+	int columns = 1;
+	int rows = 1;
+};
 
-			Vector2 point1 = *it;
-			Vector2 point2 = *next;
+void Elite::Polygon::FindMutualVisibleVertices(const BridgeGrid& outerGrid, const std::list<Vector2>& innerPoints, std::list<Vector2>::const_iterator& pOuter, std::list<Vector2>::const_iterator& pInner) const
+{
+	//1. Find vertex with the biggest x value of the inner polygon
+	const auto maxInnerPoint = std::max_element(innerPoints.begin(), innerPoints.end(),
+		[](const Vector2& p1, const Vector2& p2) { return p1.x < p2.x; });
 
-			if (point2.y > point1.y) //make sure point1.y is always higher than point1.y -> this prevents identical but reversed lines to end up in different intersection points due to rounding errors
-			{
-				point2 = point1;
-				point1 = *next;
-			}
+	//Store inner point to output
+	pInner = maxInnerPoint;
+	const Vector2 M = *maxInnerPoint;
 
-			Vector2 q = point1;
-			Vector2 s = point2 - q;
-			//Capture parallel and collinear cases
-			if (Cross(r, s) == 0)
+	// --- 2. Based on found inner point, find mutually visisble outer point
+	//2.1 Intersect ray M + t(1,0) with the edges of OUTER - Result point I. Only the grid row of M is walked, from M to the right,
+	//stopping as soon as the closest hit lies before the next cell. Bridges that are already inserted are part of OUTER as well.
+	float closestX = FLT_MAX;
+	auto hitEdge = outerGrid.pPoints->end();
+	auto hitVertex = outerGrid.pPoints->end();
+
+	const auto row = outerGrid.GetRow(M.y);
+	for (auto column = outerGrid.GetColumn(M.x); column < outerGrid.columns; ++column)
+	{
+		for (auto node = outerGrid.edgeCells[row * outerGrid.columns + column]; node != -1; node = outerGrid.edgeNodes[node].second)
+		{
+			const auto it = outerGrid.edgeNodes[node].first;
+			const auto next = outerGrid.Next(it);
+			if ((it->y > M.y && next->y > M.y) || (it->y < M.y && next->y < M.y) || max(it->x, next->x) < M.x)
+				continue;
+
+			//Edge along the ray, the closest vertex on the right is the hit
+			if (it->y == next->y)
 			{
-				if (Cross(q - p, r) == 0) //== Collinear
+				for (const auto v : { it, next })
 				{
-					//Get closest vertex (OR the correct way see link :)) - We don't check
-					//overlap because the max x of our ray is within the boundaries
-
-					if (it->x < next->x)
-					{
-						if (I.x >= it->x)
-							I = *it;
-					}
-					else
+					if (v->x >= M.x && v->x < closestX)
 					{
-						if (I.x >= next->x)
-							I = *next;
+						closestX = v->x;
+						hitVertex = v;
 					}
 				}
 				continue;
 			}
 
+			//Interior is left of the (CCW) outer edges, the ray leaves through an edge going up.
+			//This also picks the right side of a bridge, which is in the list twice (once in both directions)
+			if (next->y < it->y)
+				continue;
 
-
-			//If not parallel or collinear, search point, calculate T and U
-			float crossRS = Cross(r, s);
-			float t = Cross(q - p, s) / crossRS;
-			float u = Cross(q - p, r) / crossRS;
-
-			//If U == 0 || u == 1, endpoints touch, else if within range also a hit
-			if (t >= 0 && t <= 1 && u >= 0 && u <= 1)
+			if (it->y == M.y || next->y == M.y)
 			{
-				Vector2 tempI = p + (t * r);
+				const auto v = it->y == M.y ? it : next;
+				if (v->x >= M.x && v->x < closestX)
+				{
+					closestX = v->x;
+					hitVertex = v;
+				}
+				continue;
+			}
 
-				//take this point if none was taken before
-				bool takePoint = intersectedLine[0] == outer.m_vPoints.end() && intersectedLine[1] == outer.m_vPoints.end();
+			const auto x = it->x + (M.y - it->y) * (next->x - it->x) / (next->y - it->y);
+			if (x >= M.x && x < closestX)
+			{
+				closestX = x;
+				hitEdge = it;
+				hitVertex = outerGrid.pPoints->end();
+			}
+		}
 
+		if (closestX <= outerGrid.origin.x + (column + 1) * outerGrid.cellSize)
+			break;
+	}
 
-				//Check if closer than other intersected lines, if it is, replace stored line!
-				if (!takePoint)
-				{
-					float distanceTemp = abs(DistanceSquared(p, tempI));
-					float distanceI = abs(DistanceSquared(p, I));
-					takePoint = distanceTemp <= distanceI;
-				}
+	//2.2 IF I is vertex of OUTER == mutually visisble so terminate algorithm
+	if (hitVertex != outerGrid.pPoints->end())
+	{
+		pOuter = hitVertex;
+		return;
+	}
+	if (hitEdge == outerGrid.pPoints->end())
+	{
+		printf("\n--Error in Triangulation, no visible vertex found for hole!\n");
+		pOuter = outerGrid.pPoints->begin();
+		return;
+	}
 
-				if (takePoint)
+	//2.3 ELSE I is interior point on edge, select vertex with maximum x value of the hitted edge - Result point P
+	const Vector2 I = Vector2(closestX, M.y);
+	const auto hitNext = outerGrid.Next(hitEdge);
+	const auto P = hitEdge->x > hitNext->x ? hitEdge : hitNext;
+
+	//2.4 Search for reflex vertices (excluding P) in triangle (M,I,P), only looking in the cells the triangle covers
+	//2.5 IF there are none, then P is mutually visible == terminate algorithm
+	//2.6 ELSE pick the reflex R that minimizes the angle between (1,0) and the line (M,R), the closest one if they are equal
+	pOuter = P;
+	float smallestAngle = FLT_MAX;
+	float smallestDistance = FLT_MAX;
+	const auto maxColumn = outerGrid.GetColumn(max(I.x, P->x));
+	const auto maxRow = outerGrid.GetRow(max(M.y, P->y));
+	for (auto r = outerGrid.GetRow(min(M.y, P->y)); r <= maxRow; ++r)
+	{
+		for (auto c = outerGrid.GetColumn(M.x); c <= maxColumn; ++c)
+		{
+			for (auto node = outerGrid.vertexCells[r * outerGrid.columns + c]; node != -1; node = outerGrid.vertexNodes[node].second)
+			{
+				const auto it = outerGrid.vertexNodes[node].first;
+				if (*it == *P || !PointInTriangle(*it, M, I, *P) || IsConvexInPolygon(*outerGrid.pPoints, it))
+					continue;
+
+				const auto seg = *it - M;
+				const auto distance = seg.Magnitude();
+				const auto angle = acos(seg.x / distance);
+				if (angle < smallestAngle || (angle == smallestAngle && distance < smallestDistance))
 				{
-					//Determine point with T and U
-					I = p + (t * r);
-
-					intersectedLine[0] = it;
-					intersectedLine[1] = next;
+					smallestAngle = angle;
+					smallestDistance = distance;
+					pOuter = it;
 				}
 			}
 		}
 	}
+}
 
-	//2.2 IF I is vertex of OUTER == mutually visisble so terminate algorithm
-	const auto IOuter = std::find(outer.m_vPoints.begin(), outer.m_vPoints.end(), I);
-	if (IOuter != outer.m_vPoints.end()) //Point is vertex of outer, so I is correct vertex!
+void Elite::Polygon::Split(std::vector<const Polygon*>& holes)
+{
+	//Bridge the holes from right to left (biggest max x first). A ray to the right can then only be blocked by
+	//the outer shape or holes that are already bridged, so only those have to be in the grid.
+	size_t vertexCount = m_vPoints.size();
+	for (const auto pHole : holes)
+		vertexCount += pHole->m_vPoints.size() + 2;
+	std::sort(holes.begin(), holes.end(),
+		[](const Polygon* p1, const Polygon* p2) { return p1->GetPosVertMaxXPos() > p2->GetPosVertMaxXPos(); });
+
+	BridgeGrid grid(m_vPoints, vertexCount);
+
+	//Holes of the holes are bridged in a next pass
+	std::vector<const Polygon*> newHoles;
+	//Split polygon into pieces based on it's children (holes)
+	std::list<Vector2> holePoints;
+	for (const auto pHole : holes)
 	{
-		pOuter = IOuter;
+		holePoints.assign(pHole->m_vPoints.begin(), pHole->m_vPoints.end());
+		if (GetPolygonWinding(holePoints) != Winding::CW)
+			holePoints.reverse();
 
-		return;
+		//Find mutually visible vertices
+		std::list<Vector2>::const_iterator  itInner, itOuter;
+		FindMutualVisibleVertices(grid, holePoints, itOuter, itInner);
+
+		//Rotate the hole so it starts at the found inner vertex, untill we've reached it again, and link this back to the outer vertex.
+		//End by "duplicating" both the inner and outer vertex
+		holePoints.splice(holePoints.end(), holePoints, holePoints.cbegin(), itInner);
+		holePoints.push_back(*itInner);
+		holePoints.push_back(*itOuter);
+
+		//Move the nodes AFTER itOuter (so next), the iterators stay valid so the grid can be updated with the new edges
+		const std::list<Vector2>::const_iterator itFirst = holePoints.begin();
+		const auto insertedCount = holePoints.size();
+		m_vPoints.splice(std::next(itOuter), holePoints);
+		InvalidateBounds();
+
+		grid.AddEdge(itOuter);
+		auto it = itFirst;
+		for (size_t i = 0; i < insertedCount; ++i, ++it)
+		{
+			grid.AddEdge(it);
+			grid.AddVertex(it);
+		}
+
+		for (const auto& child : pHole->m_vChildren)
+			newHoles.push_back(&child);
 	}
+	holes.swap(newHoles);
+}
 
-	//2.3 ELSE I is interior point on edge, select vertex with maximum x value of the hitted edge - Result point P
-	std::list<Vector2>::const_iterator P = intersectedLine[(intersectedLine[0]->x > intersectedLine[1]->x ? 0 : 1)];
+namespace
+{
+	//=== Helpers to merge overlapping children ===
+	struct UnionEdge
+	{
+		Elite::Vector2 start = {};
+		Elite::Vector2 end = {};
+		int polygon = -1;
+		std::vector<std::pair<float, Elite::Vector2>> splits; //Squared distance from start, split point
+	};
 
-	//2.4 Search for reflex vertices (excluding P if it's a reflex)
-	std::list<Vector2> reflexVertices;
-	for (auto it = outer.m_vPoints.begin(); it != outer.m_vPoints.end(); ++it)
+	enum class FragmentSide
 	{
-		if (*it == *P)
-			continue;
+		Outside,
+		Inside,
+		SameBoundary, //On the boundary of the other polygon, same direction
+		OppositeBoundary //On the boundary of the other polygon, opposite direction
+	};
 
-		if (!outer.IsConvexInPolygon(outer.m_vPoints, it))
-			reflexVertices.push_back(*it);
+	struct PointCompare
+	{
+		bool operator()(const Elite::Vector2& a, const Elite::Vector2& b) const
+		{ return a.x < b.x || (a.x == b.x && a.y < b.y); }
+	};
+
+	constexpr float UnionEpsilon = 1e-4f;
+
+	float SignedArea(const std::vector<Elite::Vector2>& points)
+	{
+		float area = 0.f;
+		for (size_t i = 0; i < points.size(); ++i)
+			area += Elite::Cross(points[i], points[(i + 1) % points.size()]);
+		return area / 2.f;
 	}
 
-	//2.5 IF all reflex vertices are OUTSIDE of triangle (M,I,P), then P is mutually visible == terminate algorithm
-	std::vector<Vector2> pointsInTriangle;
-	for (auto it = reflexVertices.begin(); it != reflexVertices.end(); ++it)
+	float DistanceSquaredToSegment(const Elite::Vector2& a, const Elite::Vector2& b, const Elite::Vector2& point)
 	{
-		if (PointInTriangle(*it, *pInner, I, *P))
-			pointsInTriangle.push_back(*it);
+		//Not using DistanceSquarePointToLine, its subtraction of squares loses too much precision for thin overlaps
+		const auto dir = b - a;
+		const auto t = Elite::Clamp(Elite::Dot(point - a, dir) / Elite::Dot(dir, dir), 0.f, 1.f);
+		return Elite::DistanceSquared(a + t * dir, point);
 	}
 
-	if (pointsInTriangle.size() == 0)
+	void AddSplit(UnionEdge& edge, const Elite::Vector2& point)
 	{
-		pOuter = P;
-		return;
+		if (Elite::DistanceSquared(edge.start, point) <= Elite::Square(UnionEpsilon)
+			|| Elite::DistanceSquared(edge.end, point) <= Elite::Square(UnionEpsilon))
+			return;
+		edge.splits.push_back({ Elite::DistanceSquared(edge.start, point), point });
 	}
 
-	//2.6 ELSE at least one reflex vertex lies in triangle (M,I,P). Search for reflex R that minimizes the angle
-	//between (1,0) and the line (M,R). If found more choose one, else use the one found and terminate algorithm
-	auto smallestAngle = 2 * M_PI;
-	Vector2 smallestAnglePoint;
-	for (const auto point : pointsInTriangle)
+	void IntersectEdges(UnionEdge& e1, UnionEdge& e2)
 	{
-		//Angle between r and (M,p)
-		Vector2 seg = point - p;
-		auto angle = acos((Dot(seg, r)) / (seg.Magnitude() * r.Magnitude()));
-		if (angle < smallestAngle)
+		//http://stackoverflow.com/questions/563198/how-do-you-detect-where-two-line-segments-intersect
+		const auto r = e1.end - e1.start;
+		const auto s = e2.end - e2.start;
+		const auto qp = e2.start - e1.start;
+		const auto crossRS = Elite::Cross(r, s);
+		const auto crossQPR = Elite::Cross(qp, r);
+
+		//Parallel, only collinear overlap matters: endpoints of one edge split the other one
+		if (abs(crossRS) <= UnionEpsilon * r.Magnitude() * s.Magnitude())
 		{
-			smallestAngle = angle;
-			smallestAnglePoint = point;
+			if (abs(crossQPR) > UnionEpsilon * r.Magnitude())
+				return;
+
+			const auto isOnEdge = [](const Elite::Vector2& p, const UnionEdge& e)
+			{
+				const auto dir = e.end - e.start;
+				const auto t = Elite::Dot(p - e.start, dir) / Elite::Dot(dir, dir);
+				return t > 0.f && t < 1.f;
+			};
+			if (isOnEdge(e2.start, e1)) AddSplit(e1, e2.start);
+			if (isOnEdge(e2.end, e1)) AddSplit(e1, e2.end);
+			if (isOnEdge(e1.start, e2)) AddSplit(e2, e1.start);
+			if (isOnEdge(e1.end, e2)) AddSplit(e2, e1.end);
+			return;
 		}
+
+		const auto t = Elite::Cross(qp, s) / crossRS;
+		const auto u = crossQPR / crossRS;
+		if (t < 0.f || t > 1.f || u < 0.f || u > 1.f)
+			return;
+
+		//Snap to existing vertices, so both edges use the exact same point
+		auto point = e1.start + t * r;
+		if (Elite::DistanceSquared(point, e1.start) <= Elite::Square(UnionEpsilon)) point = e1.start;
+		else if (Elite::DistanceSquared(point, e1.end) <= Elite::Square(UnionEpsilon)) point = e1.end;
+		else if (Elite::DistanceSquared(point, e2.start) <= Elite::Square(UnionEpsilon)) point = e2.start;
+		else if (Elite::DistanceSquared(point, e2.end) <= Elite::Square(UnionEpsilon)) point = e2.end;
+		AddSplit(e1, point);
+		AddSplit(e2, point);
 	}
 
-	pOuter = std::find(outer.m_vPoints.begin(), outer.m_vPoints.end(), smallestAnglePoint);
-}
+	bool IsInsideRing(const Elite::Vector2& point, const std::vector<Elite::Vector2>& ring)
+	{
+		//Crossing number test
+		auto isInside = false;
+		for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++)
+		{
+			const auto& a = ring[i];
+			const auto& b = ring[j];
+			if ((a.y > point.y) != (b.y > point.y) && point.x < (b.x - a.x) * (point.y - a.y) / (b.y - a.y) + a.x)
+				isInside = !isInside;
+		}
+		return isInside;
+	}
+
+	FragmentSide ClassifyFragment(const Elite::Vector2& start, const Elite::Vector2& end, const std::vector<Elite::Vector2>& polygon)
+	{
+		const auto mid = (start + end) / 2.f;
+		const auto dir = end - start;
+
+		//On the boundary?
+		for (size_t i = 0; i < polygon.size(); ++i)
+		{
+			const auto& a = polygon[i];
+			const auto& b = polygon[(i + 1) % polygon.size()];
+			if (DistanceSquaredToSegment(a, b, mid) <= Elite::Square(UnionEpsilon))
+				return Elite::Dot(dir, b - a) > 0.f ? FragmentSide::SameBoundary : FragmentSide::OppositeBoundary;
+		}
+
+		return IsInsideRing(mid, polygon) ? FragmentSide::Inside : FragmentSide::Outside;
+	}
+
+	//Boolean union of simple polygons, returns the outer outlines (CCW) and the gaps they enclose (CW)
+	std::vector<std::vector<Elite::Vector2>> UnionOutlines(std::vector<std::vector<Elite::Vector2>> polygons)
+	{
+		//1. Collect all edges, every polygon CCW
+		std::vector<UnionEdge> edges;
+		for (int i = 0; i < static_cast<int>(polygons.size()); ++i)
+		{
+			auto& points = polygons[i];
+			if (SignedArea(points) < 0.f)
+				std::reverse(points.begin(), points.end());
+			for (size_t p = 0; p < points.size(); ++p)
+			{
+				UnionEdge edge;
+				edge.start = points[p];
+				edge.end = points[(p + 1) % points.size()];
+				edge.polygon = i;
+				edges.push_back(edge);
+			}
+		}
+
+		//2. Sweep over x to find the intersections, only edges overlapping in x are tested against each other
+		std::vector<int> order(edges.size());
+		for (size_t i = 0; i < order.size(); ++i)
+			order[i] = static_cast<int>(i);
+		const auto minX = [&edges](int i) { return min(edges[i].start.x, edges[i].end.x); };
+		const auto maxX = [&edges](int i) { return max(edges[i].start.x, edges[i].end.x); };
+		std::sort(order.begin(), order.end(), [&minX](int a, int b) { return minX(a) < minX(b); });
+
+		std::vector<int> active;
+		for (const auto current : order)
+		{
+			const auto sweepX = minX(current);
+			active.erase(std::remove_if(active.begin(), active.end(),
+				[&](int other) { return maxX(other) < sweepX - UnionEpsilon; }), active.end());
 
+			for (const auto other : active)
+			{
+				auto& e1 = edges[current];
+				auto& e2 = edges[other];
+				if (e1.polygon == e2.polygon)
+					continue;
+				if (max(e1.start.y, e1.end.y) < min(e2.start.y, e2.end.y) - UnionEpsilon
+					|| max(e2.start.y, e2.end.y) < min(e1.start.y, e1.end.y) - UnionEpsilon)
+					continue;
+				IntersectEdges(e1, e2);
+			}
+			active.push_back(current);
+		}
+
+		//3. A fragment can only be inside or on another polygon when the bounds of its edge overlap the bounds of that polygon.
+		//Those edge - polygon pairs come from a second sweep over x, with an active list for the edges and one for the polygons
+		struct SweepBox
+		{
+			float minX, maxX, minY, maxY;
+			int index;
+			bool isPolygon;
+		};
+		std::vector<SweepBox> boxes;
+		boxes.reserve(polygons.size() + edges.size());
+		for (int i = 0; i < static_cast<int>(polygons.size()); ++i)
+		{
+			SweepBox box{ FLT_MAX, -FLT_MAX, FLT_MAX, -FLT_MAX, i, true };
+			for (const auto& p : polygons[i])
+			{
+				box.minX = min(box.minX, p.x);
+				box.maxX = max(box.maxX, p.x);
+				box.minY = min(box.minY, p.y);
+				box.maxY = max(box.maxY, p.y);
+			}
+			boxes.push_back(box);
+		}
+		for (int i = 0; i < static_cast<int>(edges.size()); ++i)
+		{
+			const auto& edge = edges[i];
+			boxes.push_back({ min(edge.start.x, edge.end.x), max(edge.start.x, edge.end.x),
+				min(edge.start.y, edge.end.y), max(edge.start.y, edge.end.y), i, false });
+		}
+		std::sort(boxes.begin(), boxes.end(), [](const SweepBox& a, const SweepBox& b) { return a.minX < b.minX; });
+
+		std::vector<std::vector<int>> candidates(edges.size()); //Per edge, the other polygons it has to be classified against
+		std::vector<const SweepBox*> activeEdges;
+		std::vector<const SweepBox*> activePolygons;
+		for (const auto& box : boxes)
+		{
+			const auto isPassed = [&box](const SweepBox* pOther) { return pOther->maxX < box.minX - UnionEpsilon; };
+			activeEdges.erase(std::remove_if(activeEdges.begin(), activeEdges.end(), isPassed), activeEdges.end());
+			activePolygons.erase(std::remove_if(activePolygons.begin(), activePolygons.end(), isPassed), activePolygons.end());
+
+			for (const auto pOther : box.isPolygon ? activeEdges : activePolygons)
+			{
+				if (box.maxY < pOther->minY - UnionEpsilon || pOther->maxY < box.minY - UnionEpsilon)
+					continue;
+				const auto& edgeBox = box.isPolygon ? *pOther : box;
+				const auto& polygonBox = box.isPolygon ? box : *pOther;
+				if (edges[edgeBox.index].polygon != polygonBox.index)
+					candidates[edgeBox.index].push_back(polygonBox.index);
+			}
+			(box.isPolygon ? activePolygons : activeEdges).push_back(&box);
+		}
+
+		//4. Split the edges and only keep the fragments that are not inside another polygon
+		std::vector<std::pair<Elite::Vector2, Elite::Vector2>> fragments;
+		for (size_t e = 0; e < edges.size(); ++e)
+		{
+			auto& edge = edges[e];
+			std::sort(edge.splits.begin(), edge.splits.end(),
+				[](const std::pair<float, Elite::Vector2>& a, const std::pair<float, Elite::Vector2>& b) { return a.first < b.first; });
 
+			auto fragmentStart = edge.start;
+			for (size_t s = 0; s <= edge.splits.size(); ++s)
+			{
+				const auto fragmentEnd = s < edge.splits.size() ? edge.splits[s].second : edge.end;
+				if (Elite::DistanceSquared(fragmentStart, fragmentEnd) <= Elite::Square(UnionEpsilon))
+					continue;
 
-void Elite::Polygon::Split()
+				auto keep = true;
+				for (size_t c = 0; c < candidates[e].size() && keep; ++c)
+				{
+					const auto other = candidates[e][c];
+					switch (ClassifyFragment(fragmentStart, fragmentEnd, polygons[other]))
+					{
+					case FragmentSide::Inside:
+					case FragmentSide::OppositeBoundary:
+						keep = false;
+						break;
+					case FragmentSide::SameBoundary:
+						keep = edge.polygon < other; //Shared boundary, only keep one copy
+						break;
+					default:
+						break;
+					}
+				}
+				if (keep)
+					fragments.push_back({ fragmentStart, fragmentEnd });
+				fragmentStart = fragmentEnd;
+			}
+		}
+
+		//5. Chain the fragments into outlines
+		std::map<Elite::Vector2, std::vector<int>, PointCompare> outgoing;
+		for (int i = 0; i < static_cast<int>(fragments.size()); ++i)
+			outgoing[fragments[i].first].push_back(i);
+
+		std::vector<std::vector<Elite::Vector2>> outlines;
+		std::vector<bool> used(fragments.size(), false);
+		for (int first = 0; first < static_cast<int>(fragments.size()); ++first)
+		{
+			if (used[first])
+				continue;
+
+			std::vector<Elite::Vector2> outline;
+			auto current = first;
+			auto isClosed = false;
+			while (current != -1)
+			{
+				used[current] = true;
+				outline.push_back(fragments[current].first);
+				const auto& end = fragments[current].second;
+				if (!PointCompare()(end, outline[0]) && !PointCompare()(outline[0], end))
+				{
+					isClosed = true;
+					break;
+				}
+
+				//Where multiple outlines touch, take the most left turn so the outlines stay separate
+				const auto incoming = fragments[current].second - fragments[current].first;
+				auto next = -1;
+				auto bestAngle = -FLT_MAX;
+				for (const auto candidate : outgoing[end])
+				{
+					if (used[candidate])
+						continue;
+					const auto angle = Elite::AngleBetween(incoming, fragments[candidate].second - fragments[candidate].first);
+					if (angle > bestAngle)
+					{
+						bestAngle = angle;
+						next = candidate;
+					}
+				}
+				current = next;
+			}
+			if (!isClosed)
+				continue;
+
+			//Remove collinear vertices left by the splitting, ear clipping doesn't like those
+			for (size_t i = 0; i < outline.size() && outline.size() > 3;)
+			{
+				const auto& prev = outline[(i + outline.size() - 1) % outline.size()];
+				const auto& next = outline[(i + 1) % outline.size()];
+				if (abs(Elite::Cross(outline[i] - prev, next - outline[i])) <= UnionEpsilon * Elite::Distance(prev, next))
+					outline.erase(outline.begin() + i);
+				else
+					++i;
+			}
+
+			if (outline.size() >= 3)
+				outlines.push_back(outline);
+		}
+		return outlines;
+	}
+}
+
+void Elite::Polygon::MergeOverlappingChildren(std::vector<Polygon>& islands)
 {
-	//Temporary new children vector
+	const int childCount = static_cast<int>(m_vChildren.size());
+	if (childCount < 2)
+		return;
+
+	//Group the children with overlapping bounding boxes
+	std::vector<int> groups(childCount);
+	for (int i = 0; i < childCount; ++i)
+		groups[i] = i;
+	const auto findGroup = [&groups](int i)
+	{
+		while (groups[i] != i)
+			i = groups[i] = groups[groups[i]];
+		return i;
+	};
+
+	std::vector<Rect> bounds;
+	bounds.reserve(childCount);
+	for (const auto& child : m_vChildren)
+		bounds.push_back(child.GetBoundingBox());
+
+	std::vector<std::pair<int, int>> pairs;
+	GetOverlappingPairs(bounds, pairs);
+	for (const auto& pair : pairs)
+		groups[findGroup(pair.first)] = findGroup(pair.second);
+
+	//Merge every group into new children, children that don't overlap anything stay untouched
+	std::map<int, std::vector<int>> members;
+	for (int i = 0; i < childCount; ++i)
+		members[findGroup(i)].push_back(i);
+	if (static_cast<int>(members.size()) == childCount)
+		return;
+
 	std::vector<Polygon> newChildren;
-	//Split polygon into pieces based on it's children (holes)
-	for (auto child : m_vChildren)
+	std::vector<std::vector<Vector2>> courtyards;
+	for (const auto& group : members)
 	{
-		//Find mutually visible vertices
-		std::list<Vector2>::const_iterator  itInner, itOuter;
-		FindMutualVisibleVertices(*this, child, itOuter, itInner);
-
-		//insert child polygon vertices to outer starting from the found inner vertex
-		std::list<Vector2> mergeableChild;
-		for (auto it = itInner; it != child.m_vPoints.end(); ++it)
-			mergeableChild.push_back(*it);
-		for (auto it = child.m_vPoints.begin(); it != itInner; ++it)
-			mergeableChild.push_back(*it);
-		//End by "duplicating" both the inner and outer vertex
-		mergeableChild.push_back(*itInner);
-		mergeableChild.push_back(*itOuter);
+		if (group.second.size() == 1)
+		{
+			newChildren.push_back(std::move(m_vChildren[group.second[0]]));
+			continue;
+		}
 
-		//untill we've reached it again, and link this back to the outer vertex
-		m_vPoints.insert(std::next(itOuter), mergeableChild.begin(), mergeableChild.end()); //insert AFTER itOuter (so next)
+		std::vector<std::vector<Vector2>> shapes;
+		for (const auto i : group.second)
+			shapes.push_back(std::vector<Vector2>(m_vChildren[i].m_vPoints.begin(), m_vChildren[i].m_vPoints.end()));
 
-		//Add it's children as new children of this newly generated polygon. We remove the old ones later
-		for (auto newChild : child.m_vChildren)
+		//The outlines of the union are CCW, the courtyards they enclose are CW
+		for (auto& outline : UnionOutlines(shapes))
 		{
-			newChild.OrientateWithChildren(Winding::CW);
-			newChildren.push_back(newChild);
+			std::reverse(outline.begin(), outline.end()); //Inner shapes are CW, courtyards become CCW islands
+			if (SignedArea(outline) < 0.f)
+				newChildren.push_back(Polygon(outline));
+			else
+				courtyards.push_back(std::move(outline));
 		}
 	}
-	//Remove all "old" children and replace with new vector
-	m_vChildren.clear();
-	m_vChildren = newChildren;
+
+	//A courtyard can't be bridged into this shape, it becomes an island that gets triangulated on its own.
+	//Children inside a courtyard (also the ones that weren't merged) are holes of the smallest courtyard they're in
+	if (!courtyards.empty())
+	{
+		const size_t firstIsland = islands.size();
+		for (const auto& courtyard : courtyards)
+			islands.push_back(Polygon(courtyard));
+
+		std::vector<Polygon> outerChildren;
+		for (auto& child : newChildren)
+		{
+			int island = -1;
+			for (int c = 0; c < static_cast<int>(courtyards.size()); ++c)
+			{
+				if (IsInsideRing(child.m_vPoints.front(), courtyards[c])
+					&& (island == -1 || SignedArea(courtyards[c]) < SignedArea(courtyards[island])))
+					island = c;
+			}
+			if (island == -1)
+				outerChildren.push_back(std::move(child));
+			else
+				islands[firstIsland + island].AddChild(std::move(child));
+		}
+		newChildren.swap(outerChildren);
+	}
+	m_vChildren.swap(newChildren);
+}
+
+void Elite::Polygon::MakeConstrainedDelaunay()
+{
+	//Lawson flips: every edge shared by two triangles whose opposite vertex lies in the circumcircle of the other
+	//triangle gets flipped, until there are none left. Edges with one triangle are the outer shape and the holes
+	//(the constraints), the bridges between holes are shared by two triangles, so those get flipped as well.
+	//Not a sweep-line CDT: the flips can take O(n^2) in the worst case, on level meshes the ear clipping before this costs far more.
+	const int triangleCount = static_cast<int>(m_vpTriangles.size());
+	if (triangleCount < 2)
+		return;
+
+	//Unique vertices (bridged vertices are in the outline twice)
+	std::vector<Vector2> vertices;
+	vertices.reserve(triangleCount * 3);
+	for (const auto t : m_vpTriangles)
+	{
+		vertices.push_back(t->p1);
+		vertices.push_back(t->p2);
+		vertices.push_back(t->p3);
+	}
+	const auto lessPoint = [](const Vector2& a, const Vector2& b) { return a.x < b.x || (a.x == b.x && a.y < b.y); };
+	std::sort(vertices.begin(), vertices.end(), lessPoint);
+	vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+	const auto getVertex = [&](const Vector2& p)
+	{
+		return static_cast<int>(std::lower_bound(vertices.begin(), vertices.end(), p, lessPoint) - vertices.begin());
+	};
+	const auto orientation = [&vertices](int a, int b, int c)
+	{
+		const auto& pa = vertices[a];
+		const auto& pb = vertices[b];
+		const auto& pc = vertices[c];
+		return double(pb.x - pa.x) * double(pc.y - pa.y) - double(pb.y - pa.y) * double(pc.x - pa.x);
+	};
+
+	//Triangles as CCW vertex indices, edge i goes from vertex i to vertex i + 1, neighbours[i] is the triangle over edge i
+	struct FlipTriangle
+	{
+		std::array<int, 3> vertices;
+		std::array<int, 3> neighbours;
+	};
+	std::vector<FlipTriangle> triangles(triangleCount);
+	for (int i = 0; i < triangleCount; ++i)
+	{
+		const auto t = m_vpTriangles[i];
+		auto& triangle = triangles[i];
+		triangle.vertices = { { getVertex(t->p1), getVertex(t->p2), getVertex(t->p3) } };
+		triangle.neighbours = { { -1, -1, -1 } };
+		if (orientation(triangle.vertices[0], triangle.vertices[1], triangle.vertices[2]) < 0)
+			std::swap(triangle.vertices[1], triangle.vertices[2]);
+	}
+
+	//Find the neighbours by sorting the edges on their (sorted) vertices
+	std::vector<std::pair<std::pair<int, int>, int>> edges; //Vertices, slot (triangle * 3 + edge)
+	edges.reserve(triangleCount * 3);
+	for (int slot = 0; slot < triangleCount * 3; ++slot)
+	{
+		const auto& v = triangles[slot / 3].vertices;
+		const auto a = v[slot % 3], b = v[(slot + 1) % 3];
+		edges.push_back({ { min(a, b), max(a, b) }, slot });
+	}
+	std::sort(edges.begin(), edges.end());
+	for (size_t i = 1; i < edges.size(); ++i)
+	{
+		if (edges[i].first != edges[i - 1].first)
+			continue;
+		const auto s1 = edges[i - 1].second, s2 = edges[i].second;
+		triangles[s1 / 3].neighbours[s1 % 3] = s2 / 3;
+		triangles[s2 / 3].neighbours[s2 % 3] = s1 / 3;
+	}
+
+	const auto findEdge = [&triangles](int triangle, int neighbour)
+	{
+		const auto& n = triangles[triangle].neighbours;
+		return n[0] == neighbour ? 0 : (n[1] == neighbour ? 1 : 2);
+	};
+	//Is d inside the circumcircle of the CCW triangle (a, b, c)? Scaled tolerance so (nearly) cocircular points don't flip back and forth
+	const auto inCircumcircle = [&vertices](int a, int b, int c, int d)
+	{
+		const auto& pd = vertices[d];
+		const double adx = vertices[a].x - pd.x, ady = vertices[a].y - pd.y;
+		const double bdx = vertices[b].x - pd.x, bdy = vertices[b].y - pd.y;
+		const double cdx = vertices[c].x - pd.x, cdy = vertices[c].y - pd.y;
+		const double ad = adx * adx + ady * ady, bd = bdx * bdx + bdy * bdy, cd = cdx * cdx + cdy * cdy;
+		const double det = ad * (bdx * cdy - cdx * bdy) - bd * (adx * cdy - cdx * ady) + cd * (adx * bdy - bdx * ady);
+		return det > 1e-9 * (ad + bd + cd) * (ad + bd + cd);
+	};
+
+	std::vector<std::pair<int, int>> stack; //Triangle, edge
+	stack.reserve(triangleCount * 3);
+	for (int i = 0; i < triangleCount; ++i)
+		for (int e = 0; e < 3; ++e)
+			if (triangles[i].neighbours[e] > i)
+				stack.push_back({ i, e });
+
+	while (!stack.empty())
+	{
+		const auto t = stack.back().first;
+		const auto e = stack.back().second;
+		stack.pop_back();
+
+		const auto u = triangles[t].neighbours[e];
+		if (u == -1)
+			continue;
+
+		//T = (a, b, c) with edge a->b, U = (b, a, d)
+		const auto a = triangles[t].vertices[e];
+		const auto b = triangles[t].vertices[(e + 1) % 3];
+		const auto c = triangles[t].vertices[(e + 2) % 3];
+		const auto ue = findEdge(u, t);
+		const auto d = triangles[u].vertices[(ue + 2) % 3];
+		if (!inCircumcircle(a, b, c, d) || orientation(a, d, c) <= 0 || orientation(d, b, c) <= 0)
+			continue;
+
+		const auto nbc = triangles[t].neighbours[(e + 1) % 3];
+		const auto nca = triangles[t].neighbours[(e + 2) % 3];
+		const auto nad = triangles[u].neighbours[(ue + 1) % 3];
+		const auto ndb = triangles[u].neighbours[(ue + 2) % 3];
+
+		//Flip to T = (a, d, c) and U = (d, b, c)
+		triangles[t].vertices = { { a, d, c } };
+		triangles[t].neighbours = { { nad, u, nca } };
+		triangles[u].vertices = { { d, b, c } };
+		triangles[u].neighbours = { { ndb, nbc, t } };
+		if (nad != -1)
+			triangles[nad].neighbours[findEdge(nad, u)] = t;
+		if (nbc != -1)
+			triangles[nbc].neighbours[findEdge(nbc, t)] = u;
+
+		//The outer edges of the quad might not be Delaunay anymore
+		stack.push_back({ t, 0 });
+		stack.push_back({ t, 2 });
+		stack.push_back({ u, 0 });
+		stack.push_back({ u, 1 });
+	}
+
+	//Write back, same triangle objects so nothing gets reallocated
+	for (int i = 0; i < triangleCount; ++i)
+	{
+		const auto& v = triangles[i].vertices;
+		auto t = m_vpTriangles[i];
+		t->p1 = vertices[v[0]];
+		t->p2 = vertices[v[1]];
+		t->p3 = vertices[v[2]];
+	}
 }
 #pragma endregion //PrivateTriangulationFunctions
 //----------------------------------------------------------
@@ -720,3 +1977,41 @@ Elite::Rect::Rect(Vector2 bottomLeft, float width, float height)
 	:bottomLeft(bottomLeft), width(width), height(height)
 {
 }
+
+void Elite::GetOverlapping(const Rect& query, const std::vector<Rect>& rects, std::vector<int>& overlapping)
+{
+	overlapping.clear();
+	for (int i = 0; i < static_cast<int>(rects.size()); ++i)
+	{
+		if (IsOverlapping(query, rects[i]))
+			overlapping.push_back(i);
+	}
+}
+
+void Elite::GetOverlappingPairs(const std::vector<Rect>& rects, std::vector<std::pair<int, int>>& pairs)
+{
+	pairs.clear();
+
+	//Sweep over x, only the rects that are still "open" at the left side of the current one can overlap it
+	std::vector<int> order(rects.size());
+	for (int i = 0; i < static_cast<int>(order.size()); ++i)
+		order[i] = i;
+	std::sort(order.begin(), order.end(), [&rects](int a, int b) { return rects[a].bottomLeft.x < rects[b].bottomLeft.x; });
+
+	std::vector<int> active;
+	for (const auto current : order)
+	{
+		const auto& rect = rects[current];
+		active.erase(std::remove_if(active.begin(), active.end(),
+			[&](int other) { return rects[other].bottomLeft.x + rects[other].width < rect.bottomLeft.x; }), active.end());
+
+		for (const auto other : active)
+		{
+			if (rect.bottomLeft.y > rects[other].bottomLeft.y + rects[other].height
+				|| rects[other].bottomLeft.y > rect.bottomLeft.y + rect.height)
+				continue;
+			pairs.push_back({ min(current, other), max(current, other) });
+		}
+		active.push_back(current);
+	}
+}
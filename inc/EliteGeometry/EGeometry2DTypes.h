@@ -16,6 +16,12 @@ namespace Elite
 	//=== Options ===
 	#define USE_TRIANGLE_METADATA
 
+	enum class TriangulationMode
+	{
+		EarClipping, //Fastest, but gives a lot of sliver triangles
+		ConstrainedDelaunay //Ear clipping followed by edge flips until the mesh is constrained Delaunay (well shaped triangles), O(n^2) worst case like the ear clipping itself
+	};
+
 	//=== Types ===
 #pragma region Line
 	struct Line final
@@ -77,7 +83,44 @@ namespace Elite
 	};
 #pragma endregion //Triangle
 
+#pragma region Rect
+	struct Rect final
+	{
+		Rect();
+		Rect(Vector2 bottomLeft, float width, float height);
+
+		Vector2 bottomLeft;
+		float width;
+		float height;
+	};
+
+	inline bool IsOverlapping(const Rect& a, const Rect& b)
+	{
+		// If one rectangle is on left side of the other
+		if (a.bottomLeft.x + a.width < b.bottomLeft.x|| b.bottomLeft.x + b.width < a.bottomLeft.x)
+		{
+			return false;
+		}
+
+		// If one rectangle is under the other
+		if (a.bottomLeft.y > b.bottomLeft.y + b.height || b.bottomLeft.y > a.bottomLeft.y + a.height)
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	//Batch overlap tests. Touching rects count as overlapping (like IsOverlapping)
+	//Outputs the indices of the rects overlapping the query rect, one linear pass (sorting for a single query costs more than it saves)
+	void GetOverlapping(const Rect& query, const std::vector<Rect>& rects, std::vector<int>& overlapping);
+	//Outputs every overlapping pair (i < j) of the given rects, sorted and swept over x so not every pair is tested
+	void GetOverlappingPairs(const std::vector<Rect>& rects, std::vector<std::pair<int, int>>& pairs);
+#pragma endregion //Rect
+
 #pragma region Polygon
+	class TriangulationCache;
+	class WorkerPool;
 	class Polygon final
 	{
 	public:
@@ -89,10 +132,17 @@ namespace Elite
 		explicit Polygon(const Vector2* vertices, int count);
 		~Polygon();
 
+		//Copies get their own triangles and lines, moving hands them over
+		Polygon(const Polygon& other);
+		Polygon(Polygon&& other) noexcept;
+		Polygon& operator=(const Polygon& other);
+		Polygon& operator=(Polygon&& other) noexcept;
+
 		//=== Functions ===
 		//Child functionality
 		Polygon* AddChild(std::list<Vector2>& vertices);
 		void AddChild(const Polygon& p);
+		void AddChild(Polygon&& p);
 		void RemoveChild(const Polygon& p);
 
 		//General functions
@@ -111,6 +161,7 @@ namespace Elite
 		float GetPosVertMaxYPos() const;
 		float GetPosVertMinXPos() const;
 		float GetPosVertMinYPos() const;
+		Rect GetBoundingBox() const;
 		bool OverlappingXAxis(const Polygon& poly) const;
 		bool OverlappingYAxis(const Polygon& poly) const;
 		std::vector<Triangle*> GetAdjacentTriangles(const Triangle* t) const;
@@ -124,9 +175,22 @@ namespace Elite
 
 
 		//Triangulation functions
-		const std::vector<Triangle*>& Triangulate();
+		//Overlapping holes get merged, the courtyards they enclose are triangulated as islands (not connected to the rest),
+		//on the workers of pPool when one is given. simplifyTolerance > 0 runs Simplify on the outline and the holes before triangulating
+		const std::vector<Triangle*>& Triangulate(TriangulationMode mode = TriangulationMode::EarClipping, float simplifyTolerance = 0.f, WorkerPool* pPool = nullptr);
 		void OrientateWithChildren(Winding winding);
 		void ExpandShape(float amount);
+		//Removes near duplicate and (nearly) collinear vertices (Douglas-Peucker) of this shape and it's children.
+		//Shapes that would intersect themselves or another shape are left untouched. Returns the amount of removed vertices
+		int Simplify(float tolerance);
+
+		//Triangulation cache
+		//Hash over the points of this shape and all it's children (so call it before triangulating, bridging changes the points)
+		uint64_t GetContentHash() const;
+		//The cache holds one entry per key, reading looks for the key. Returns false if there's no (valid) entry.
+		//The key should cover everything the triangulation depends on (content hash, triangulation mode, simplify tolerance, ...)
+		bool ReadTriangulationCache(TriangulationCache& cache, uint64_t key);
+		bool WriteTriangulationCache(TriangulationCache& cache, uint64_t key) const;
 
 		//=== Operators ===
 		bool operator ==(const Polygon& b) const
@@ -139,6 +203,10 @@ namespace Elite
 		std::vector<Triangle*> m_vpTriangles; //Triangles create for this polygon, used for rendering
 		std::vector<Line*> m_vpLines; //Lines constructing this polygon!
 		bool m_isTriangulated = false;
+		//Bounding box of m_vPoints, computed when asked for. Anything changing m_vPoints has to call InvalidateBounds
+		mutable Vector2 m_BoundsMin = {};
+		mutable Vector2 m_BoundsMax = {};
+		mutable bool m_IsBoundsDirty = true;
 
 		//=== Functions ===
 		//Private General Functions
@@ -146,41 +214,49 @@ namespace Elite
 		bool IsConvexInPolygon(const std::list<Vector2>& l, const std::list<Vector2>::const_iterator p) const;
 		bool IsEar(const std::list<Vector2>& l, const std::list<Vector2>::const_iterator p) const;
 		void GenerateLineMatrix();
+		void UpdateBounds() const;
+		void InvalidateBounds() { m_IsBoundsDirty = true; }
 
 		//Private Triangulation Functions
-		void FindMutualVisibleVertices(const Polygon& outer, const Polygon& inner, std::list<Vector2>::const_iterator& pOuter, std::list<Vector2>::const_iterator& pInner);
-		void Split();
+		struct BridgeGrid;
+		void FindMutualVisibleVertices(const BridgeGrid& outerGrid, const std::list<Vector2>& innerPoints, std::list<Vector2>::const_iterator& pOuter, std::list<Vector2>::const_iterator& pInner) const;
+		void Split(std::vector<const Polygon*>& holes);
+		void MergeOverlappingChildren(std::vector<Polygon>& islands);
+		void TriangulateShape(TriangulationMode mode, float simplifyTolerance);
+		void MakeConstrainedDelaunay();
 	};
 #pragma endregion //Polygon
 
-#pragma region Rect
-	struct Rect final
+#pragma region TriangulationCache
+	//Triangulations by key, kept in memory so looking one up or adding one never touches the disk.
+	//Load once at the start and Save once at the end, the file keeps the most recently used entries (at most 64 or 16 MB).
+	//A file that is invalid (other version, cut off entry, ...) loads as far as it is valid and gets rewritten on Save
+	class TriangulationCache final
 	{
-		Rect();
-		Rect(Vector2 bottomLeft, float width, float height);
-
-		Vector2 bottomLeft;
-		float width;
-		float height;
-	};
+	public:
+		//Returns false when there was nothing to load
+		bool Load(const std::string& filePath);
+		//Only writes when something changed since Load
+		bool Save(const std::string& filePath) const;
 
-	inline bool IsOverlapping(const Rect& a, const Rect& b)
-	{
-		// If one rectangle is on left side of the other
-		if (a.bottomLeft.x + a.width < b.bottomLeft.x|| b.bottomLeft.x + b.width < a.bottomLeft.x)
-		{
-			return false;
-		}
+		//The entry as Polygon::WriteTriangulationCache made it, nullptr if there's none. Marks it as used
+		const std::vector<char>* Find(uint64_t key);
+		//Replaces the least recently used entry when full
+		void Add(uint64_t key, std::vector<char>&& data);
 
-		// If one rectangle is under the other
-		if (a.bottomLeft.y > b.bottomLeft.y + b.height || b.bottomLeft.y > a.bottomLeft.y + a.height)
+	private:
+		struct Entry
 		{
-			return false;
-		}
+			uint64_t key;
+			uint64_t lastUse;
+			std::vector<char> data;
+		};
+		std::vector<Entry> m_Entries;
+		uint64_t m_UseCount = 0;
+		bool m_IsModified = false;
+	};
+#pragma endregion //TriangulationCache
 
-		return true;
-	}
-#pragma endregion //Rect
 
 }
 #endif
\ No newline at end of file
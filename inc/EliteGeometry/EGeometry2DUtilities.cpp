@@ -0,0 +1,59 @@
+/*=============================================================================*/
+// Copyright 2021-2022 Elite Engine
+/*=============================================================================*/
+// EGeometry2DUtilities.cpp: Batch versions of the 2D Geometry Utilities.
+/*=============================================================================*/
+#include "stdafx.h"
+#include "EGeometry2DUtilities.h"
+
+using namespace Elite;
+
+namespace
+{
+	TriangleSoA GetTriangleSoA(const TriangleArrays& triangles)
+	{
+		return { triangles.x1.data(), triangles.y1.data(), triangles.x2.data(), triangles.y2.data(), triangles.x3.data(), triangles.y3.data() };
+	}
+
+	CircleSoA GetCircleSoA(const CircleArrays& circles)
+	{
+		return { circles.centerX.data(), circles.centerY.data(), circles.radius.data() };
+	}
+}
+
+void Elite::PointInTriangles(const Vector2& point, const TriangleArrays& triangles, std::vector<uint8_t>& results, bool onLineAllowed)
+{
+	results.resize(triangles.GetSize());
+	Simd::PointInTriangles(point, GetTriangleSoA(triangles), triangles.GetSize(), onLineAllowed, results.data());
+}
+
+int Elite::FindPointInTriangles(const Vector2& point, const TriangleArrays& triangles, bool onLineAllowed)
+{
+	return Simd::FindPointInTriangles(point, GetTriangleSoA(triangles), triangles.GetSize(), onLineAllowed);
+}
+
+void Elite::IsPointInTriangles(const Vector2& point, const TriangleArrays& triangles, std::vector<uint8_t>& results)
+{
+	results.resize(triangles.GetSize());
+	Simd::IsPointInTriangles(point, GetTriangleSoA(triangles), triangles.GetSize(), results.data());
+}
+
+void Elite::AreSegmentsIntersectingWithCircles(const SegmentArrays& segments, const CircleArrays& circles, std::vector<uint8_t>& results)
+{
+	const size_t segmentCount = segments.GetSize();
+	const size_t circleCount = circles.GetSize();
+	results.resize(segmentCount * circleCount);
+
+	const CircleSoA circleSoA{ GetCircleSoA(circles) };
+	for (size_t segment = 0; segment < segmentCount; ++segment)
+	{
+		const Vector2 start{ segments.startX[segment], segments.startY[segment] };
+		const Vector2 end{ segments.endX[segment], segments.endY[segment] };
+		Simd::SegmentCircles(start, end, circleSoA, circleCount, results.data() + segment * circleCount);
+	}
+}
+
+bool Elite::IsSegmentIntersectingWithCircles(const Vector2& startSegment, const Vector2& endSegment, const CircleArrays& circles)
+{
+	return Simd::SegmentAnyCircle(startSegment, endSegment, GetCircleSoA(circles), circles.GetSize());
+}
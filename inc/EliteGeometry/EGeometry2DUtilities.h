@@ -35,35 +35,19 @@ namespace Elite
 		//	2-------1		 1-------2			 3-------2
 		//	   ??				CCW				    CW
 
-		//polygon angles should add up to 360 degrees (2 PI)
-
-		float sumAngle{ 0.f };
-
-		Elite::Vector2 firstSegment{};
-		Elite::Vector2 prevSegment{};
-		Elite::Vector2 currSegment{};
+		//Shoelace sum over all the edges (closing edge included), positive means clockwise.
+		//Summing the angles between the segments instead breaks on (nearly) collinear points, where the angle flips between -PI and PI
+		double sum{ 0.0 };
 		auto it = shape.begin();
-		auto next = std::next(it);
-		
-		firstSegment = prevSegment = Elite::Vector2{ next->x - it->x, next->y - it->y };
-
-		while ( next != shape.end())
+		if (it == shape.end())
+			return CW;
+		for (auto next = std::next(it); it != shape.end(); ++it, ++next)
 		{
-			it = next;
-			next = std::next(it);
-			if (next != shape.end())
-			{
-				currSegment = Elite::Vector2{ next->x - it->x, next->y - it->y };
-			}
-			else
-			{
-				currSegment = firstSegment;
-			}
-			
-			sumAngle += Elite::AngleBetween(currSegment, -prevSegment);
-			prevSegment = currSegment;
+			if (next == shape.end())
+				next = shape.begin();
+			sum += (double(next->x) - it->x) * (double(next->y) + it->y);
 		}
-		if (sumAngle <= 0)
+		if (sum >= 0)
 			return CW;
 		return CCW;
 	}
@@ -213,5 +197,60 @@ namespace Elite
 
 		return false;
 	}
+
+	/* --- BATCH FUNCTIONS --- */
+	//Structure of arrays versions of the tests above, they run on the Simd kernels of ESimdDispatch (4 or 8 tests at once).
+	//The math is done in the same order as the single versions, so the results are exactly the same.
+	/*! Triangles as structure of arrays. p1 is used as tip, p2 as prev and p3 as next. */
+	struct TriangleArrays
+	{
+		std::vector<float> x1, y1, x2, y2, x3, y3;
+
+		void Add(const Vector2& p1, const Vector2& p2, const Vector2& p3)
+		{
+			x1.push_back(p1.x); y1.push_back(p1.y);
+			x2.push_back(p2.x); y2.push_back(p2.y);
+			x3.push_back(p3.x); y3.push_back(p3.y);
+		}
+		void Clear() { x1.clear(); y1.clear(); x2.clear(); y2.clear(); x3.clear(); y3.clear(); }
+		size_t GetSize() const { return x1.size(); }
+	};
+	/*! Segments as structure of arrays. */
+	struct SegmentArrays
+	{
+		std::vector<float> startX, startY, endX, endY;
+
+		void Add(const Vector2& start, const Vector2& end)
+		{
+			startX.push_back(start.x); startY.push_back(start.y);
+			endX.push_back(end.x); endY.push_back(end.y);
+		}
+		void Clear() { startX.clear(); startY.clear(); endX.clear(); endY.clear(); }
+		size_t GetSize() const { return startX.size(); }
+	};
+	/*! Circles as structure of arrays. */
+	struct CircleArrays
+	{
+		std::vector<float> centerX, centerY, radius;
+
+		void Add(const Vector2& center, float circleRadius)
+		{
+			centerX.push_back(center.x); centerY.push_back(center.y);
+			radius.push_back(circleRadius);
+		}
+		void Clear() { centerX.clear(); centerY.clear(); radius.clear(); }
+		size_t GetSize() const { return centerX.size(); }
+	};
+
+	/*! PointInTriangle of one point against all triangles, results[i] is 1 when the point is in triangle i. */
+	void PointInTriangles(const Vector2& point, const TriangleArrays& triangles, std::vector<uint8_t>& results, bool onLineAllowed = false);
+	/*! Index of the first triangle PointInTriangle returns true for, -1 if there is none. */
+	int FindPointInTriangles(const Vector2& point, const TriangleArrays& triangles, bool onLineAllowed = false);
+	/*! IsPointInTriangle of one point against all triangles, results[i] is 1 when the point is in triangle i. */
+	void IsPointInTriangles(const Vector2& point, const TriangleArrays& triangles, std::vector<uint8_t>& results);
+	/*! IsSegmentIntersectingWithCircle of every segment against every circle, results[segment * circleCount + circle]. */
+	void AreSegmentsIntersectingWithCircles(const SegmentArrays& segments, const CircleArrays& circles, std::vector<uint8_t>& results);
+	/*! True when the segment intersects any of the circles. */
+	bool IsSegmentIntersectingWithCircles(const Vector2& startSegment, const Vector2& endSegment, const CircleArrays& circles);
 }
 #endif
\ No newline at end of file
@@ -41,6 +41,7 @@ namespace Elite
 		MouseData MouseInputData;
 		KeyboardData KeyboardInputData;
 
+		InputData() : KeyboardInputData() {}
 		InputData(MouseData data) : MouseInputData(data) {}
 		InputData(KeyboardData data) : KeyboardInputData(data) {}
 	};
@@ -4,45 +4,48 @@
 using namespace Elite;
 
 //=== Public Functions ===
-MouseData EInputManager::GetMouseData(InputType type, InputMouseButton button)
+MouseData EInputManager::GetMouseData(InputType type, InputMouseButton button) const
 {
-	auto result = std::find_if(m_InputContainer.begin(), m_InputContainer.end(),
-		[type, button](const InputAction& ia)
-	{
-		return
-			(ia.InputActionType == type) &&
-			(ia.InputActionData.MouseInputData.Button == button);
-	});
-
-	if (result != m_InputContainer.end())
-		return (*result).InputActionData.MouseInputData;
-	return
-		MouseData();
+	if (!IsValidMouse(type, button) || !m_HasMouseData[GetMouseIndex(type, button)])
+		return MouseData();
+	return m_MouseData[GetMouseIndex(type, button)];
 }
 
 //=== Private Functions ===
-bool EInputManager::IsKeyPresent(InputType type, InputState state, InputScancode code)
+void EInputManager::Flush()
 {
-	auto result = std::find_if(m_InputContainer.begin(), m_InputContainer.end(),
-		[type, state, code](const InputAction& ia)
-	{
-		return
-			(ia.InputActionType == type) &&
-			(ia.InputActionState == state) &&
-			(ia.InputActionData.KeyboardInputData.ScanCode == code);
-	});
-	return (result != m_InputContainer.end());
+	m_KeyEvents.reset();
+	m_MouseEvents.reset();
+	m_HasMouseData.reset();
+
+	m_InputQueue.PopAll([this](const InputAction& inputAction) { AddInputAction(inputAction); });
+	m_DroppedLastFrame = m_InputQueue.TakeDroppedCount();
+	m_DroppedTotal += m_DroppedLastFrame;
 }
 
-bool EInputManager::IsMousePresent(InputType type, InputState state, InputMouseButton button)
+void EInputManager::AddInputAction(const InputAction& inputAction)
 {
-	auto result = std::find_if(m_InputContainer.begin(), m_InputContainer.end(),
-		[type, state, button](const InputAction& ia)
+	const InputState state = inputAction.InputActionState;
+	if (inputAction.InputActionType == eKeyboard)
+	{
+		const InputScancode code = inputAction.InputActionData.KeyboardInputData.ScanCode;
+		if (!IsValidKey(code))
+			return;
+		m_KeyEvents[state * ScancodeCount + code] = true;
+		m_KeysPressed[code] = (state == eDown);
+		return;
+	}
+
+	const MouseData& data = inputAction.InputActionData.MouseInputData;
+	if (!IsValidMouse(inputAction.InputActionType, data.Button))
+		return;
+	const int index = GetMouseIndex(inputAction.InputActionType, data.Button);
+	m_MouseEvents[index * 2 + state] = true;
+	if (!m_HasMouseData[index])
 	{
-		return
-			(ia.InputActionType == type) &&
-			(ia.InputActionState == state) &&
-			(ia.InputActionData.MouseInputData.Button == button);
-	});
-	return (result != m_InputContainer.end());
+		m_HasMouseData[index] = true;
+		m_MouseData[index] = data;
+	}
+	if (inputAction.InputActionType == eMouseButton)
+		m_MouseButtonsPressed[data.Button] = (state == eDown);
 }
\ No newline at end of file
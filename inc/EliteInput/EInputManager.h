@@ -7,6 +7,9 @@
 #ifndef ELITE_INPUT_MANAGER
 #define	ELITE_INPUT_MANAGER
 
+#include <bitset>
+#include "EInputQueue.h"
+
 namespace Elite
 {
 	//=== Forward Declaration ===
@@ -18,14 +21,30 @@ namespace Elite
 	class EInputManager final : public ESingleton<EInputManager>
 	{
 	public:
-		bool IsKeyboardKeyDown(InputScancode key) { return IsKeyPresent(eKeyboard, eDown, key); };
-		bool IsKeyboardKeyUp(InputScancode key) { return IsKeyPresent(eKeyboard, eReleased, key); }
+		//Sizes of the state table: SDL has 512 scancodes, mouse buttons go up to X2 (5)
+		static constexpr int ScancodeCount{ 512 };
+		static constexpr int MouseButtonCount{ 8 };
+		static constexpr int MouseTypeCount{ eMouseMotion - eMouseButton + 1 };
+
+		bool IsKeyboardKeyDown(InputScancode key) const { return IsKeyPresent(eDown, key); };
+		bool IsKeyboardKeyUp(InputScancode key) const { return IsKeyPresent(eReleased, key); }
+		/*! Held down, from its down event until its released event (also in the frames in between) */
+		bool IsKeyboardKeyPressed(InputScancode key) const { return IsValidKey(key) && m_KeysPressed[key]; }
+
+		bool IsMouseButtonDown(InputMouseButton button) const { return IsMousePresent(eMouseButton, eDown, button); }
+		bool IsMouseButtonUp(InputMouseButton button) const { return IsMousePresent(eMouseButton, eReleased, button); }
+		/*! Held down, from its down event until its released event (also in the frames in between) */
+		bool IsMouseButtonPressed(InputMouseButton button) const { return IsValidButton(button) && m_MouseButtonsPressed[button]; }
+		bool IsMouseScrolling() const { return IsMousePresent(eMouseWheel); }
+		bool IsMouseMoving() const { return IsMousePresent(eMouseMotion); }
+		MouseData GetMouseData(InputType type, InputMouseButton button = InputMouseButton(0)) const;
 
-		bool IsMouseButtonDown(InputMouseButton button) { return IsMousePresent(eMouseButton, eDown, button); }
-		bool IsMouseButtonUp(InputMouseButton button) { return IsMousePresent(eMouseButton, eReleased, button); }
-		bool IsMouseScrolling() { return IsMousePresent(eMouseWheel); }
-		bool IsMouseMoving() { return IsMousePresent(eMouseMotion); }
-		MouseData GetMouseData(InputType type, InputMouseButton button = InputMouseButton(0));
+		/*! Queues an action from another thread (event thread, headless driver), false when the queue is full and it was dropped.
+			Only one thread may queue actions, they are applied in the next Flush */
+		bool QueueInputAction(const InputAction& inputAction) { return m_InputQueue.Push(inputAction); }
+		/*! Queued actions dropped because the queue was full, in the last Flush and in total */
+		uint32_t GetDroppedActionCount() const { return m_DroppedLastFrame; }
+		uint64_t GetTotalDroppedActionCount() const { return m_DroppedTotal; }
 
 	private:
 		//=== Friends ===
@@ -35,15 +54,34 @@ namespace Elite
 #endif
 
 		//=== Internal Functions
-		void Flush(){ m_InputContainer.clear();};
-		void AddInputAction(const InputAction& inputAction) 
-		{ m_InputContainer.push_back(inputAction); };
+		//Clears last frame's events, then applies the actions queued from other threads
+		void Flush();
+		//From the window, on the thread that queries: applied right away
+		void AddInputAction(const InputAction& inputAction);
 
-		bool IsKeyPresent(InputType type, InputState state, InputScancode code);
-		bool IsMousePresent(InputType type, InputState state = InputState(0), InputMouseButton button = InputMouseButton(0));
+		bool IsKeyPresent(InputState state, InputScancode code) const
+		{ return IsValidKey(code) && m_KeyEvents[state * ScancodeCount + code]; }
+		bool IsMousePresent(InputType type, InputState state = InputState(0), InputMouseButton button = InputMouseButton(0)) const
+		{ return IsValidMouse(type, button) && m_MouseEvents[GetMouseIndex(type, button) * 2 + state]; }
+
+		static bool IsValidKey(int code) { return code >= 0 && code < ScancodeCount; }
+		static bool IsValidButton(int button) { return button >= 0 && button < MouseButtonCount; }
+		static bool IsValidMouse(int type, int button) { return type >= eMouseButton && type <= eMouseMotion && IsValidButton(button); }
+		static int GetMouseIndex(int type, int button) { return (type - eMouseButton) * MouseButtonCount + button; }
 
 		//=== Datamembers ===
-		std::vector<InputAction> m_InputContainer;
+		InputActionQueue m_InputQueue{};
+		uint32_t m_DroppedLastFrame{};
+		uint64_t m_DroppedTotal{};
+
+		//State table, filled as the actions are added so every query is a bit test instead of a search through the events.
+		//The event bits and mouse data only hold this frame (cleared in Flush), the pressed bits stay until the release.
+		std::bitset<2 * ScancodeCount> m_KeyEvents{}; //[state][scancode]
+		std::bitset<ScancodeCount> m_KeysPressed{};
+		std::bitset<2 * MouseTypeCount * MouseButtonCount> m_MouseEvents{}; //[type][button][state]
+		std::bitset<MouseButtonCount> m_MouseButtonsPressed{};
+		std::bitset<MouseTypeCount * MouseButtonCount> m_HasMouseData{};
+		MouseData m_MouseData[MouseTypeCount * MouseButtonCount]{}; //first event of every type and button this frame
 	};
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,66 @@
+/*=============================================================================*/
+// Copyright 2021-2022 Elite Engine
+/*=============================================================================*/
+// EInputQueue.h: bounded lock-free queue of input actions, one producer thread and one consumer thread
+/*=============================================================================*/
+#ifndef ELITE_INPUT_QUEUE
+#define	ELITE_INPUT_QUEUE
+
+#include <atomic>
+#include <cstdint>
+
+namespace Elite
+{
+	/*! InputActionQueue: ring buffer between the thread that receives the events (window, headless driver)
+		and the thread that reads them (simulation). Push never blocks, a full queue drops the action and counts it.
+		Safe for exactly one pushing thread and one popping thread at the same time. */
+	class InputActionQueue final
+	{
+	public:
+		static constexpr uint32_t Capacity{ 1024 }; //power of 2, so the indices wrap with a mask
+
+		//=== Producer ===
+		bool Push(const InputAction& inputAction)
+		{
+			const uint32_t tail = m_Tail.load(std::memory_order_relaxed);
+			//Only read the consumer's index when the cached one says the queue is full
+			if (tail - m_CachedHead == Capacity)
+			{
+				m_CachedHead = m_Head.load(std::memory_order_acquire);
+				if (tail - m_CachedHead == Capacity)
+				{
+					m_DroppedCount.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				}
+			}
+			m_Actions[tail & (Capacity - 1)] = inputAction;
+			m_Tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		//=== Consumer ===
+		/*! Calls process(const InputAction&) for the actions pushed before the call, in order.
+			Actions pushed while it runs wait for the next call, so a fast producer can't keep the consumer busy */
+		template<typename Process>
+		uint32_t PopAll(Process process)
+		{
+			const uint32_t head = m_Head.load(std::memory_order_relaxed);
+			const uint32_t tail = m_Tail.load(std::memory_order_acquire);
+			for (uint32_t i = head; i != tail; ++i)
+				process(m_Actions[i & (Capacity - 1)]);
+			m_Head.store(tail, std::memory_order_release);
+			return tail - head;
+		}
+		/*! Actions dropped because the queue was full since the last call */
+		uint32_t TakeDroppedCount() { return m_DroppedCount.exchange(0, std::memory_order_relaxed); }
+
+	private:
+		//Producer and consumer data on separate cache lines, so they don't invalidate each other's line on every action
+		alignas(64) std::atomic<uint32_t> m_Tail{ 0 };
+		uint32_t m_CachedHead{ 0 }; //producer's copy of m_Head
+		std::atomic<uint32_t> m_DroppedCount{ 0 };
+		alignas(64) std::atomic<uint32_t> m_Head{ 0 };
+		alignas(64) InputAction m_Actions[Capacity]{};
+	};
+}
+#endif
\ No newline at end of file
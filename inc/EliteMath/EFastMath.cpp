@@ -0,0 +1,82 @@
+/*=============================================================================*/
+// Copyright 2021-2022 Elite Engine
+/*=============================================================================*/
+// EFastMath.cpp: Error and speed report of the fast trigonometry against libm
+/*=============================================================================*/
+#include "stdafx.h"
+#include "EFastMath.h"
+#include <chrono>
+
+namespace
+{
+	template<typename Function>
+	float MeasureMilliseconds(Function function)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		function();
+		const auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<float, std::milli>(end - start).count();
+	}
+}
+
+void Elite::PrintFastMathReport()
+{
+	constexpr size_t count{ 1 << 18 };
+	std::mt19937 generator{ 5489u };
+	std::uniform_real_distribution<float> angleDistribution{ -100.f, 100.f };
+	std::uniform_real_distribution<float> coordinateDistribution{ -50.f, 50.f };
+
+	std::vector<float> angles(count), x(count), y(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		angles[i] = angleDistribution(generator);
+		x[i] = coordinateDistribution(generator);
+		y[i] = coordinateDistribution(generator);
+	}
+	//Every octant border
+	for (size_t i = 0; i < 9; ++i)
+	{
+		x[i] = cosf(static_cast<float>(i) * static_cast<float>(E_PI_4));
+		y[i] = sinf(static_cast<float>(i) * static_cast<float>(E_PI_4));
+	}
+
+	//Errors against double precision
+	double sinError{}, cosError{}, atan2Error{};
+	for (size_t i = 0; i < count; ++i)
+	{
+		sinError = max(sinError, fabs(FastSin(angles[i]) - sin(static_cast<double>(angles[i]))));
+		cosError = max(cosError, fabs(FastCos(angles[i]) - cos(static_cast<double>(angles[i]))));
+		atan2Error = max(atan2Error, fabs(FastAtan2(y[i], x[i]) - atan2(static_cast<double>(y[i]), static_cast<double>(x[i]))));
+	}
+
+	std::vector<float> sines(count), cosines(count), results(count);
+	const float libmSinCos = MeasureMilliseconds([&]()
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			sines[i] = sinf(angles[i]);
+			cosines[i] = cosf(angles[i]);
+		}
+	});
+	const float fastSinCos = MeasureMilliseconds([&]()
+	{
+		for (size_t i = 0; i < count; ++i)
+			FastSinCos(angles[i], sines[i], cosines[i]);
+	});
+	const float batchSinCos = MeasureMilliseconds([&]() { Simd::SinCos(angles.data(), count, sines.data(), cosines.data()); });
+	const float libmAtan2 = MeasureMilliseconds([&]()
+	{
+		for (size_t i = 0; i < count; ++i)
+			results[i] = atan2f(y[i], x[i]);
+	});
+	const float fastAtan2 = MeasureMilliseconds([&]()
+	{
+		for (size_t i = 0; i < count; ++i)
+			results[i] = FastAtan2(y[i], x[i]);
+	});
+	const float batchAtan2 = MeasureMilliseconds([&]() { Simd::Atan2(y.data(), x.data(), count, results.data()); });
+
+	printf("Fast math, max error: sin %.2e, cos %.2e (|angle| <= 100), atan2 %.2e\n", sinError, cosError, atan2Error);
+	printf("Fast math, %d values: sin+cos libm %.2f ms, fast %.2f ms, batch (%s) %.2f ms | atan2 libm %.2f ms, fast %.2f ms, batch %.2f ms\n",
+		static_cast<int>(count), libmSinCos, fastSinCos, GetSimdLevelName(GetSimdLevel()), batchSinCos, libmAtan2, fastAtan2, batchAtan2);
+}
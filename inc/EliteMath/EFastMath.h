@@ -0,0 +1,86 @@
+/*=============================================================================*/
+// Copyright 2021-2022 Elite Engine
+/*=============================================================================*/
+// EFastMath.h: Polynomial sin, cos and atan2, for floats and for the float packs of EVector2SoA.h
+/*=============================================================================*/
+#ifndef ELITE_MATH_FAST_MATH
+#define	ELITE_MATH_FAST_MATH
+
+namespace Elite
+{
+	//Max absolute error against the double precision functions (PrintFastMathReport measures them):
+	//	FastSin, FastCos: 2.1e-7 for |angle| <= 100, 2.8e-7 for |angle| <= 1e4, the range reduction gets worse after that
+	//	FastAtan2: 2.0e-6 radians, atan2(+-0, -0) gives 0 where libm gives +-pi
+	//The orientation helpers in EVector2.h use them when ELITE_FAST_TRIG is defined.
+	//Needs /fp:precise (the default), /fp:fast can optimize the rounding in FastReduceAngle away.
+
+	/* --- SCALAR HELPERS --- */
+	//Same behaviour as the pack versions, so the templates below work on floats and packs with the same results
+	inline float Select(bool condition, float a, float b) { return condition ? a : b; }
+	inline float Min(float a, float b) { return a < b ? a : b; }
+	inline float Max(float a, float b) { return a > b ? a : b; }
+
+	/* --- FUNCTIONS --- */
+	/*! Angle in [-pi, pi] with the same sin and cos */
+	template<typename T>
+	inline T FastReduceAngle(const T& angle)
+	{
+		//Adding and subtracting 1.5 * 2^23 rounds to the nearest integer, 2 pi is split so turns * 6.28125 is exact
+		const T roundMagic(12582912.f);
+		const T turns = (angle * T(0.159154943f) + roundMagic) - roundMagic;
+		return (angle - turns * T(6.28125f)) - turns * T(1.93530717e-3f);
+	}
+
+	/*! Minimax polynomial of sin on [-pi/2, pi/2] */
+	template<typename T>
+	inline T FastSinReduced(const T& x)
+	{
+		const T x2 = x * x;
+		return x + x * x2 * (T(-1.6666667e-1f) + x2 * (T(8.3333310e-3f) + x2 * (T(-1.9840874e-4f)
+			+ x2 * (T(2.7525562e-6f) + x2 * T(-2.3889859e-8f)))));
+	}
+
+	template<typename T>
+	inline T FastSin(const T& angle)
+	{
+		//sin(x) = sin(pi - x) = sin(-pi - x) folds [-pi, pi] into [-pi/2, pi/2]
+		const T x = FastReduceAngle(angle);
+		const T halfPi(1.57079633f), pi(3.14159265f);
+		return FastSinReduced(Select(x > halfPi, pi - x, Select(x < T(0.f) - halfPi, T(0.f) - pi - x, x)));
+	}
+
+	template<typename T>
+	inline T FastCos(const T& angle)
+	{
+		//cos(x) = sin(pi/2 - |x|)
+		const T x = FastReduceAngle(angle);
+		return FastSinReduced(T(1.57079633f) - Max(x, T(0.f) - x));
+	}
+
+	template<typename T>
+	inline void FastSinCos(const T& angle, T& sine, T& cosine)
+	{
+		sine = FastSin(angle);
+		cosine = FastCos(angle);
+	}
+
+	template<typename T>
+	inline T FastAtan2(const T& y, const T& x)
+	{
+		//Minimax polynomial of atan on [0, 1], the octant is put back after
+		const T zero(0.f);
+		const T absX = Max(x, zero - x), absY = Max(y, zero - y);
+		const T maxXY = Max(absX, absY), minXY = Min(absX, absY);
+		const T t = Select(maxXY > zero, minXY / maxXY, zero);
+		const T t2 = t * t;
+		T angle = t * (T(0.99997726f) + t2 * (T(-0.33262347f) + t2 * (T(0.19354346f) + t2 * (T(-0.11643287f)
+			+ t2 * (T(0.05265332f) + t2 * T(-0.01172120f))))));
+		angle = Select(absY > absX, T(1.57079633f) - angle, angle);
+		angle = Select(x < zero, T(3.14159265f) - angle, angle);
+		return Select(y < zero, zero - angle, angle);
+	}
+
+	/*! Logs the measured errors against libm and the speed of libm, the scalar and the batch versions */
+	void PrintFastMathReport();
+}
+#endif
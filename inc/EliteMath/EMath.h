@@ -10,12 +10,18 @@
 /* --- STANDARD --- */
 #include <math.h>
 /* --- UTILITIES --- */
+#include "ERandom.h"
 #include "EMathUtilities.h"
+#include "EFastMath.h"
 /* --- TYPES --- */
 #include "EVector2.h"
+#include "EVector2SoA.h"
+#include "ESimdDispatch.h"
 #include "EVector3.h"
 #include "EMat22.h"
 #include "FMatrix.h"
+#include "ESparseMatrix.h"
+#include "ENeuralNetwork.h"
 
 /* --- TYPE DEFINES --- */
 #endif
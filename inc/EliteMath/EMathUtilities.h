@@ -91,20 +91,17 @@ namespace Elite {
 		return a;
 	}
 
-	/*! Random Integer */
+	/*! Random Integer in [0, max), from the generator of the calling thread (see ERandom.h) */
 	inline int randomInt(int max = 1)
-	{ return rand() % max; }
+	{ return GetThreadRandom().NextInt(max); }
 
 	/*! Random Float */
 	inline float randomFloat(float max = 1.f)
-	{ return max * (float(rand()) / RAND_MAX); }
+	{ return max * GetThreadRandom().NextFloat(); }
 
 	/*! Random Float */
 	inline float randomFloat(float min, float max)
-	{
-		auto range = max - min;
-		return (range * (float(rand()) / RAND_MAX)) + min;
-	}
+	{ return GetThreadRandom().NextFloat(min, max); }
 
 	/*! Random Binomial Float */
 	inline float randomBinomial(float max = 1.f)
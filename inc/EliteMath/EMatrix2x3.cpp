@@ -18,6 +18,31 @@ Elite::Vector2 Matrix2x3::Transform(const Elite::Vector2& vector) const
 	return Elite::Vector2{ vector.x * dirX + vector.y * dirY } + orig;
 }
 
+Elite::Vector2 Matrix2x3::TransformVector(const Elite::Vector2& vector) const
+{
+	return Elite::Vector2{ vector.x * dirX + vector.y * dirY };
+}
+
+void Matrix2x3::TransformPoints(const Elite::Vector2* pPoints, size_t count, Elite::Vector2* pResults) const
+{
+	Elite::Simd::Transform(&dirX.x, pPoints, count, true, pResults);
+}
+
+void Matrix2x3::TransformPoints(std::vector<Elite::Vector2>& points) const
+{
+	TransformPoints(points.data(), points.size(), points.data());
+}
+
+void Matrix2x3::TransformVectors(const Elite::Vector2* pVectors, size_t count, Elite::Vector2* pResults) const
+{
+	Elite::Simd::Transform(&dirX.x, pVectors, count, false, pResults);
+}
+
+void Matrix2x3::TransformVectors(std::vector<Elite::Vector2>& vectors) const
+{
+	TransformVectors(vectors.data(), vectors.size(), vectors.data());
+}
+
 float Matrix2x3::Determinant() const
 {
 	return dirX.x * dirY.y - dirX.y * dirY.x;
@@ -130,6 +155,64 @@ Matrix2x3 Matrix2x3::CreateTranslationMatrix(float tx, float ty)
 	return CreateTranslationMatrix( Elite::Vector2{ tx, ty } );
 }
 
+ComposedTransform::ComposedTransform(const Matrix2x3& local, const ComposedTransform* pParent)
+	: m_Local{ local }, m_pParent{ pParent }
+{}
+
+void ComposedTransform::SetLocal(const Matrix2x3& local)
+{
+	m_Local = local;
+	++m_LocalVersion;
+}
+
+void ComposedTransform::SetParent(const ComposedTransform* pParent)
+{
+	m_pParent = pParent;
+	++m_LocalVersion;
+}
+
+const Matrix2x3& ComposedTransform::GetWorld() const
+{
+	UpdateWorld();
+	return m_World;
+}
+
+const Matrix2x3& ComposedTransform::GetInverseWorld() const
+{
+	UpdateWorld();
+	if (!m_IsInverseValid)
+	{
+		m_InverseWorld = m_World.Inverse();
+		m_IsInverseValid = true;
+	}
+	return m_InverseWorld;
+}
+
+unsigned int ComposedTransform::GetWorldVersion() const
+{
+	UpdateWorld();
+	return m_WorldVersion;
+}
+
+void ComposedTransform::TransformPoints(const Elite::Vector2* pPoints, size_t count, Elite::Vector2* pResults) const
+{
+	GetWorld().TransformPoints(pPoints, count, pResults);
+}
+
+void ComposedTransform::UpdateWorld() const
+{
+	//The parent updates first, its version tells if the cached product is still right
+	const unsigned int parentVersion{ m_pParent != nullptr ? m_pParent->GetWorldVersion() : 0 };
+	if (m_CachedLocalVersion == m_LocalVersion && m_CachedParentVersion == parentVersion)
+		return;
+
+	m_World = m_pParent != nullptr ? m_pParent->m_World * m_Local : m_Local;
+	m_IsInverseValid = false;
+	m_CachedLocalVersion = m_LocalVersion;
+	m_CachedParentVersion = parentVersion;
+	++m_WorldVersion;
+}
+
 // Operator overloading functionality
 bool operator==(const Matrix2x3& lhs, const Matrix2x3& rhs) 
 {
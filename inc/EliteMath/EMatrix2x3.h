@@ -16,6 +16,16 @@ struct Matrix2x3
 	// -------------------------
 	// Elite::Vector2 vTransformed = mat.Transform(v);
 	Elite::Vector2 Transform( const Elite::Vector2& v ) const;
+	// Transform without the translation, for directions and offsets
+	Elite::Vector2 TransformVector( const Elite::Vector2& v ) const;
+
+	// Transform of count points, with the SIMD kernels. pResults can be pPoints to transform in place
+	// mat.TransformPoints(points.data(), points.size(), results.data());
+	void TransformPoints( const Elite::Vector2* pPoints, size_t count, Elite::Vector2* pResults ) const;
+	void TransformPoints( std::vector<Elite::Vector2>& points ) const;
+	// TransformVector of count vectors, pResults can be pVectors to transform in place
+	void TransformVectors( const Elite::Vector2* pVectors, size_t count, Elite::Vector2* pResults ) const;
+	void TransformVectors( std::vector<Elite::Vector2>& vectors ) const;
 
 	// Calculate the determinant
 	float Determinant( ) const;
@@ -76,6 +86,47 @@ struct Matrix2x3
 	Elite::Vector2 orig; 	// The origin of  the coordinate matrix (the "translation"), third column
 };
 
+// The batch transforms read the matrix as 6 floats
+static_assert(sizeof(Matrix2x3) == 6 * sizeof(float), "Matrix2x3 has to be dirX, dirY, orig without padding");
+
+// -------------------------------------------
+// Composed transform with a cached result
+// -------------------------------------------
+// World = parent world * local. The world matrix and its inverse are only recomputed when the local
+// matrix or one of the parents changed since the last call, so a hierarchy can be asked for it every frame.
+// The parent has to outlive the child.
+class ComposedTransform
+{
+public:
+	explicit ComposedTransform( const Matrix2x3& local = Matrix2x3{}, const ComposedTransform* pParent = nullptr );
+
+	void SetLocal( const Matrix2x3& local );
+	void SetParent( const ComposedTransform* pParent );
+	const Matrix2x3& GetLocal( ) const { return m_Local; }
+
+	const Matrix2x3& GetWorld( ) const;
+	const Matrix2x3& GetInverseWorld( ) const;
+	// Changes every time the world matrix changes, to cache things computed from it
+	unsigned int GetWorldVersion( ) const;
+
+	// Local points to world space with GetWorld()
+	void TransformPoints( const Elite::Vector2* pPoints, size_t count, Elite::Vector2* pResults ) const;
+
+private:
+	void UpdateWorld( ) const;
+
+	Matrix2x3 m_Local;
+	const ComposedTransform* m_pParent;
+	unsigned int m_LocalVersion{ 1 };
+
+	mutable Matrix2x3 m_World{};
+	mutable Matrix2x3 m_InverseWorld{};
+	mutable bool m_IsInverseValid{ false };
+	mutable unsigned int m_WorldVersion{ 0 };
+	mutable unsigned int m_CachedLocalVersion{ 0 };
+	mutable unsigned int m_CachedParentVersion{ 0 };
+};
+
 // -------------------------
 // Operators 
 // -------------------------
@@ -0,0 +1,239 @@
+/*=============================================================================*/
+// Copyright 2021-2022 Elite Engine
+/*=============================================================================*/
+// ENeuralNetwork.cpp: Loading and evaluation of the feed forward network
+/*=============================================================================*/
+#include "stdafx.h"
+#include "ENeuralNetwork.h"
+
+namespace
+{
+	constexpr char FileMagic[4]{ 'E', 'M', 'L', 'P' };
+	constexpr uint32_t FileVersion{ 1 };
+	constexpr uint32_t MaxLayerSize{ 1 << 16 }; //anything bigger is a broken file
+	constexpr uint64_t MaxLayerWeights{ 1 << 22 }; //16 MB of weights in one layer
+
+	template<typename T>
+	bool Read(std::ifstream& file, T& value)
+	{
+		return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+	}
+	bool Read(std::ifstream& file, float* pValues, size_t count)
+	{
+		return static_cast<bool>(file.read(reinterpret_cast<char*>(pValues), count * sizeof(float)));
+	}
+
+	template<typename T>
+	void Write(std::ofstream& file, const T& value)
+	{
+		file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+}
+
+bool Elite::NeuralNetwork::LoadFromFile(const std::string& path, int maxBatchSize)
+{
+	Clear();
+
+	std::ifstream file{ path, std::ios::binary };
+	if (!file)
+	{
+		printf("NeuralNetwork: can't open %s\n", path.c_str());
+		return false;
+	}
+
+	file.seekg(0, std::ios::end);
+	const std::streamoff fileSize{ file.tellg() };
+	file.seekg(0, std::ios::beg);
+
+	char magic[4]{};
+	uint32_t version{}, layerCount{};
+	if (!file.read(magic, sizeof(magic)) || memcmp(magic, FileMagic, sizeof(magic)) != 0
+		|| !Read(file, version) || version != FileVersion || !Read(file, layerCount) || layerCount == 0)
+	{
+		printf("NeuralNetwork: %s is not a version %u network file\n", path.c_str(), FileVersion);
+		return false;
+	}
+
+	std::vector<Layer> layers(layerCount);
+	std::vector<float> rowMajorWeights{};
+	for (uint32_t i = 0; i < layerCount; ++i)
+	{
+		uint32_t inputs{}, outputs{}, activation{};
+		if (!Read(file, inputs) || !Read(file, outputs) || !Read(file, activation))
+		{
+			printf("NeuralNetwork: %s ends in the header of layer %u\n", path.c_str(), i);
+			return false;
+		}
+		const bool isChained = i == 0 || static_cast<int>(inputs) == layers[i - 1].weights.GetNrOfRows();
+		//Check the size against the limit and the rest of the file before allocating, a broken header can ask for GBs
+		const uint64_t weightCount{ static_cast<uint64_t>(inputs) * outputs };
+		const uint64_t bytesLeft{ static_cast<uint64_t>(fileSize - file.tellg()) };
+		if (inputs == 0 || outputs == 0 || inputs > MaxLayerSize || outputs > MaxLayerSize || !isChained
+			|| weightCount > MaxLayerWeights || (weightCount + outputs) * sizeof(float) > bytesLeft
+			|| activation > static_cast<uint32_t>(Activation::Tanh))
+		{
+			printf("NeuralNetwork: layer %u of %s is invalid (%u inputs, %u outputs, activation %u)\n", i, path.c_str(), inputs, outputs, activation);
+			return false;
+		}
+
+		Layer& layer = layers[i];
+		layer.activation = static_cast<Activation>(activation);
+		layer.weights.Resize(static_cast<int>(outputs), static_cast<int>(inputs));
+		layer.biases.Resize(static_cast<int>(outputs), 1);
+		rowMajorWeights.resize(static_cast<size_t>(outputs) * inputs);
+		if (!Read(file, rowMajorWeights.data(), rowMajorWeights.size()) || !Read(file, layer.biases.GetData(), outputs))
+		{
+			printf("NeuralNetwork: %s ends in the weights of layer %u\n", path.c_str(), i);
+			return false;
+		}
+
+		//FMatrix is column major
+		float* pWeights = layer.weights.GetData();
+		for (uint32_t r = 0; r < outputs; ++r)
+		{
+			for (uint32_t c = 0; c < inputs; ++c)
+				pWeights[c * outputs + r] = rowMajorWeights[r * inputs + c];
+		}
+	}
+
+	m_Layers = std::move(layers);
+	SetMaxBatchSize(maxBatchSize);
+	return true;
+}
+
+bool Elite::NeuralNetwork::SaveToFile(const std::string& path) const
+{
+	std::ofstream file{ path, std::ios::binary };
+	if (!file)
+	{
+		printf("NeuralNetwork: can't write %s\n", path.c_str());
+		return false;
+	}
+
+	file.write(FileMagic, sizeof(FileMagic));
+	Write(file, FileVersion);
+	Write(file, static_cast<uint32_t>(m_Layers.size()));
+	for (const Layer& layer : m_Layers)
+	{
+		const int outputs = layer.weights.GetNrOfRows();
+		const int inputs = layer.weights.GetNrOfColumns();
+		Write(file, static_cast<uint32_t>(inputs));
+		Write(file, static_cast<uint32_t>(outputs));
+		Write(file, static_cast<uint32_t>(layer.activation));
+		for (int r = 0; r < outputs; ++r)
+		{
+			for (int c = 0; c < inputs; ++c)
+				Write(file, layer.weights.Get(r, c));
+		}
+		file.write(reinterpret_cast<const char*>(layer.biases.GetData()), outputs * sizeof(float));
+	}
+	return static_cast<bool>(file);
+}
+
+void Elite::NeuralNetwork::Create(const std::vector<int>& layerSizes, Activation hiddenActivation, Activation outputActivation, float scale, int maxBatchSize)
+{
+	Clear();
+	if (layerSizes.size() < 2)
+		return;
+
+	m_Layers.resize(layerSizes.size() - 1);
+	for (size_t i = 0; i < m_Layers.size(); ++i)
+	{
+		Layer& layer = m_Layers[i];
+		layer.activation = i + 1 == m_Layers.size() ? outputActivation : hiddenActivation;
+		layer.weights.Resize(layerSizes[i + 1], layerSizes[i]);
+		layer.weights.Randomize(-scale, scale);
+		layer.biases.Resize(layerSizes[i + 1], 1);
+		layer.biases.SetAll(0.f);
+	}
+	SetMaxBatchSize(maxBatchSize);
+}
+
+void Elite::NeuralNetwork::SetMaxBatchSize(int maxBatchSize)
+{
+	m_MaxBatchSize = max(maxBatchSize, 1);
+	for (Layer& layer : m_Layers)
+		layer.outputs.Resize(layer.weights.GetNrOfRows(), m_MaxBatchSize);
+}
+
+void Elite::NeuralNetwork::Clear()
+{
+	m_Layers.clear();
+	m_MaxBatchSize = 0;
+}
+
+bool Elite::NeuralNetwork::Evaluate(const float* pInputs, float* pOutputs)
+{
+	if (!IsLoaded())
+		return false;
+
+	const float* pResult = Forward(pInputs, GetInputCount(), 1);
+	memcpy(pOutputs, pResult, GetOutputCount() * sizeof(float));
+	return true;
+}
+
+bool Elite::NeuralNetwork::Evaluate(const FMatrix& inputs, FMatrix& outputs)
+{
+	const int batchSize = inputs.GetNrOfColumns();
+	if (!IsLoaded() || inputs.GetNrOfRows() != GetInputCount() || batchSize > m_MaxBatchSize
+		|| outputs.GetNrOfRows() != GetOutputCount() || outputs.GetNrOfColumns() < batchSize)
+	{
+		printf("NeuralNetwork: can't evaluate %d x %d inputs into %d x %d outputs\n",
+			inputs.GetNrOfRows(), batchSize, outputs.GetNrOfRows(), outputs.GetNrOfColumns());
+		return false;
+	}
+	if (batchSize == 0)
+		return true;
+
+	//The outputs of the last layer are packed like the outputs matrix, column major with GetOutputCount() rows
+	const float* pResult = Forward(inputs.GetData(), inputs.GetNrOfRows(), batchSize);
+	memcpy(outputs.GetData(), pResult, static_cast<size_t>(GetOutputCount()) * batchSize * sizeof(float));
+	return true;
+}
+
+const float* Elite::NeuralNetwork::Forward(const float* pInputs, int inputStride, int batchSize)
+{
+	const float* pLayerInputs = pInputs;
+	int layerInputStride = inputStride;
+	for (Layer& layer : m_Layers)
+	{
+		const int outputs = layer.weights.GetNrOfRows();
+		float* pOutputs = layer.outputs.GetData();
+		Simd::MatrixMultiply(layer.weights.GetData(), outputs, pLayerInputs, layerInputStride, pOutputs, outputs,
+			outputs, layer.weights.GetNrOfColumns(), batchSize);
+
+		const float* pBiases = layer.biases.GetData();
+		for (int c = 0; c < batchSize; ++c)
+		{
+			float* pColumn = pOutputs + c * outputs;
+			for (int r = 0; r < outputs; ++r)
+				pColumn[r] += pBiases[r];
+		}
+		Activate(layer.activation, pOutputs, outputs * batchSize);
+
+		pLayerInputs = pOutputs;
+		layerInputStride = outputs;
+	}
+	return pLayerInputs;
+}
+
+void Elite::NeuralNetwork::Activate(Activation activation, float* pValues, int count)
+{
+	switch (activation)
+	{
+	case Activation::ReLU:
+		for (int i = 0; i < count; ++i)
+			pValues[i] = pValues[i] > 0.f ? pValues[i] : 0.f;
+		break;
+	case Activation::Sigmoid:
+		for (int i = 0; i < count; ++i)
+			pValues[i] = 1.f / (1.f + expf(-pValues[i]));
+		break;
+	case Activation::Tanh:
+		for (int i = 0; i < count; ++i)
+			pValues[i] = tanhf(pValues[i]);
+		break;
+	default:
+		break;
+	}
+}
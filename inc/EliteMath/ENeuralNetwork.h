@@ -0,0 +1,64 @@
+/*=============================================================================*/
+// Copyright 2021-2022 Elite Engine
+/*=============================================================================*/
+// ENeuralNetwork.h: Feed forward network (multilayer perceptron) inference on top of FMatrix
+/*=============================================================================*/
+#ifndef ELITE_MATH_NEURAL_NETWORK
+#define	ELITE_MATH_NEURAL_NETWORK
+
+namespace Elite
+{
+	enum class Activation
+	{
+		Linear = 0,
+		ReLU = 1,
+		Sigmoid = 2,
+		Tanh = 3
+	};
+
+	//Every layer computes outputs = activation(weights * inputs + biases). A batch is a matrix with one column per sample,
+	//so a whole batch goes through one MatrixMultiply per layer. The layer buffers are allocated for the max batch size
+	//when the network is built, Evaluate never allocates.
+	class NeuralNetwork final
+	{
+	public:
+		/*! Binary file, little endian:
+			char[4] "EMLP", uint32 version (1), uint32 layer count, then for every layer:
+			uint32 inputs, uint32 outputs, uint32 activation (see Activation),
+			float weights[outputs][inputs] (row major, the order numpy writes them in), float biases[outputs] */
+		bool LoadFromFile(const std::string& path, int maxBatchSize = 1);
+		bool SaveToFile(const std::string& path) const;
+
+		/*! Builds the network in code, layerSizes[0] is the input count. The weights are random in [-scale, scale], the biases 0 */
+		void Create(const std::vector<int>& layerSizes, Activation hiddenActivation, Activation outputActivation, float scale, int maxBatchSize = 1);
+		void SetMaxBatchSize(int maxBatchSize);
+		void Clear();
+
+		bool IsLoaded() const { return !m_Layers.empty(); }
+		int GetInputCount() const { return m_Layers.empty() ? 0 : m_Layers.front().weights.GetNrOfColumns(); }
+		int GetOutputCount() const { return m_Layers.empty() ? 0 : m_Layers.back().weights.GetNrOfRows(); }
+		int GetMaxBatchSize() const { return m_MaxBatchSize; }
+
+		/*! One sample, pInputs has GetInputCount() values, pOutputs gets GetOutputCount() values */
+		bool Evaluate(const float* pInputs, float* pOutputs);
+		/*! Every column of inputs is a sample (at most GetMaxBatchSize()), outputs gets a column per sample */
+		bool Evaluate(const FMatrix& inputs, FMatrix& outputs);
+
+	private:
+		struct Layer
+		{
+			FMatrix weights{}; //outputs x inputs
+			FMatrix biases{}; //outputs x 1
+			FMatrix outputs{}; //outputs x max batch size
+			Activation activation{ Activation::Linear };
+		};
+
+		//Runs batchSize samples (column major, inputStride floats apart) through the layers, returns the outputs of the last one
+		const float* Forward(const float* pInputs, int inputStride, int batchSize);
+		static void Activate(Activation activation, float* pValues, int count);
+
+		std::vector<Layer> m_Layers{};
+		int m_MaxBatchSize{};
+	};
+}
+#endif
@@ -0,0 +1,132 @@
+/*=============================================================================*/
+// Copyright 2021-2022 Elite Engine
+/*=============================================================================*/
+// ERandom.cpp: Batch generation and the per thread generators
+/*=============================================================================*/
+#include "stdafx.h"
+#include "ERandom.h"
+#include <atomic>
+
+using namespace Elite;
+
+namespace
+{
+	std::atomic<uint64_t> g_Seed{ 0 };
+	std::atomic<uint32_t> g_SeedVersion{ 0 }; //SeedRandom bumps it, every thread generator reseeds when it changed
+
+	struct ThreadRandom
+	{
+		Random random{};
+		uint32_t stream{ 0 };
+		uint32_t seedVersion{ 0 };
+		bool isSeeded{ false };
+	};
+
+	ThreadRandom& GetThreadState()
+	{
+		thread_local ThreadRandom state{};
+		return state;
+	}
+
+	using StreamState = uint32_t[4][RandomStreams::Lanes];
+
+	//Same steps as Random::NextUInt in every lane, * 5 and * 9 as shifts and adds because SSE2 has no 32 bit multiply.
+	//The fills work on a local copy of the state, so the compiler knows the results don't alias it and vectorizes this.
+	inline void NextBlock(StreamState& state, uint32_t* pResults)
+	{
+		for (int l = 0; l < RandomStreams::Lanes; ++l)
+		{
+			const uint32_t s1 = state[1][l];
+			const uint32_t times5 = (s1 << 2) + s1;
+			const uint32_t rotated = (times5 << 7) | (times5 >> 25);
+			pResults[l] = (rotated << 3) + rotated;
+
+			const uint32_t t = s1 << 9;
+			state[2][l] ^= state[0][l];
+			state[3][l] ^= s1;
+			state[1][l] = s1 ^ state[2][l];
+			state[0][l] ^= state[3][l];
+			state[2][l] ^= t;
+			state[3][l] = (state[3][l] << 11) | (state[3][l] >> 21);
+		}
+	}
+}
+
+RandomStreams::RandomStreams(const Random& random)
+{
+	Random lane{ random };
+	for (int l = 0; l < Lanes; ++l)
+	{
+		for (int i = 0; i < 4; ++i)
+			m_State[i][l] = lane.GetState(i);
+		lane.Jump();
+	}
+}
+
+void RandomStreams::FillUniform(float* pValues, size_t count, float min, float max)
+{
+	const float range = max - min;
+	StreamState state;
+	memcpy(state, m_State, sizeof(state));
+	uint32_t block[Lanes];
+	size_t i = 0;
+	for (; i + Lanes <= count; i += Lanes)
+	{
+		NextBlock(state, block);
+		for (int l = 0; l < Lanes; ++l)
+			pValues[i + l] = min + range * Random::ToFloat(block[l]);
+	}
+	if (i < count)
+	{
+		NextBlock(state, block);
+		for (size_t l = 0; i + l < count; ++l)
+			pValues[i + l] = min + range * Random::ToFloat(block[l]);
+	}
+	memcpy(m_State, state, sizeof(state));
+}
+
+void RandomStreams::FillNormal(float* pValues, size_t count, float mean, float deviation)
+{
+	StreamState state;
+	memcpy(state, m_State, sizeof(state));
+	uint32_t first[Lanes], second[Lanes];
+	for (size_t i = 0; i < count; i += 2 * Lanes)
+	{
+		NextBlock(state, first);
+		NextBlock(state, second);
+		float normals[2 * Lanes];
+		for (int l = 0; l < Lanes; ++l)
+			Random::ToNormal(first[l], second[l], normals[l], normals[Lanes + l]);
+
+		const size_t blockCount = count - i < 2 * Lanes ? count - i : 2 * Lanes;
+		for (size_t l = 0; l < blockCount; ++l)
+			pValues[i + l] = mean + deviation * normals[l];
+	}
+	memcpy(m_State, state, sizeof(state));
+}
+
+Random& Elite::GetThreadRandom()
+{
+	ThreadRandom& state = GetThreadState();
+	const uint32_t seedVersion = g_SeedVersion.load(std::memory_order_acquire);
+	if (!state.isSeeded || state.seedVersion != seedVersion)
+	{
+		state.random = Random::FromStream(g_Seed.load(std::memory_order_relaxed), state.stream);
+		state.seedVersion = seedVersion;
+		state.isSeeded = true;
+	}
+	return state.random;
+}
+
+void Elite::SetThreadRandomStream(uint32_t stream)
+{
+	ThreadRandom& state = GetThreadState();
+	state.stream = stream;
+	state.isSeeded = false;
+}
+
+void Elite::SeedRandom(uint64_t seed)
+{
+	g_Seed.store(seed, std::memory_order_relaxed);
+	g_SeedVersion.fetch_add(1, std::memory_order_release);
+}
@@ -0,0 +1,167 @@
+/*=============================================================================*/
+// Copyright 2021-2022 Elite Engine
+/*=============================================================================*/
+// ERandom.h: Small deterministic random generator (xoshiro128**) with independent streams
+/*=============================================================================*/
+#ifndef ELITE_MATH_RANDOM
+#define	ELITE_MATH_RANDOM
+
+#include <cstdint>
+
+namespace Elite
+{
+	//xoshiro128** (Blackman & Vigna): 128 bit state, period 2^128 - 1, 32 bit results.
+	//Jump() skips 2^64 results, so stream i of a seed (the seeded generator jumped i times) never overlaps another stream.
+	//Give every worker, bot or sampler its own stream and the results only depend on the seed, not on the thread timing.
+	class Random final
+	{
+	public:
+		explicit Random(uint64_t seed = 0) { Seed(seed); }
+
+		/*! Stream of the seed, the same seed and stream always give the same numbers */
+		static Random FromStream(uint64_t seed, uint32_t stream)
+		{
+			Random random{ seed };
+			for (uint32_t i = 0; i < stream; ++i)
+				random.Jump();
+			return random;
+		}
+
+		void Seed(uint64_t seed)
+		{
+			//SplitMix64 spreads any seed (also 0) over the state, it can't give the all zero state
+			for (int i = 0; i < 2; ++i)
+			{
+				const uint64_t value = SplitMix64(seed);
+				m_State[2 * i] = static_cast<uint32_t>(value);
+				m_State[2 * i + 1] = static_cast<uint32_t>(value >> 32);
+			}
+			m_HasSpareNormal = false;
+		}
+
+		uint32_t NextUInt()
+		{
+			const uint32_t result = RotateLeft(m_State[1] * 5, 7) * 9;
+			const uint32_t t = m_State[1] << 9;
+			m_State[2] ^= m_State[0];
+			m_State[3] ^= m_State[1];
+			m_State[1] ^= m_State[2];
+			m_State[0] ^= m_State[3];
+			m_State[2] ^= t;
+			m_State[3] = RotateLeft(m_State[3], 11);
+			return result;
+		}
+		/*! [0, 1) */
+		float NextFloat() { return ToFloat(NextUInt()); }
+		/*! [min, max) */
+		float NextFloat(float min, float max) { return min + (max - min) * NextFloat(); }
+		/*! [0, max), 0 when max <= 0 */
+		int NextInt(int max)
+		{
+			//Multiply and keep the high half instead of %, no division and a smaller bias
+			return max > 0 ? static_cast<int>((static_cast<uint64_t>(NextUInt()) * static_cast<uint32_t>(max)) >> 32) : 0;
+		}
+		/*! Standard normal distribution (Box-Muller, the second value of a pair is kept for the next call) */
+		float NextNormal()
+		{
+			if (m_HasSpareNormal)
+			{
+				m_HasSpareNormal = false;
+				return m_SpareNormal;
+			}
+			float first{};
+			ToNormal(NextUInt(), NextUInt(), first, m_SpareNormal);
+			m_HasSpareNormal = true;
+			return first;
+		}
+		float NextNormal(float mean, float deviation) { return mean + deviation * NextNormal(); }
+
+		/*! Skips 2^64 results */
+		void Jump()
+		{
+			constexpr uint32_t jump[4]{ 0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b };
+			uint32_t state[4]{};
+			for (const uint32_t word : jump)
+			{
+				for (int bit = 0; bit < 32; ++bit)
+				{
+					if (word & (1u << bit))
+					{
+						for (int i = 0; i < 4; ++i)
+							state[i] ^= m_State[i];
+					}
+					NextUInt();
+				}
+			}
+			for (int i = 0; i < 4; ++i)
+				m_State[i] = state[i];
+			m_HasSpareNormal = false;
+		}
+		/*! A copy of this generator, this one jumps ahead, so both go on without overlapping */
+		Random Split()
+		{
+			Random split{ *this };
+			split.m_HasSpareNormal = false;
+			Jump();
+			return split;
+		}
+
+		uint32_t GetState(int index) const { return m_State[index]; }
+
+		//Shared with RandomStreams, so both give the same floats for the same bits
+		static uint32_t RotateLeft(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+		static float ToFloat(uint32_t bits) { return static_cast<float>(bits >> 8) * (1.f / 16777216.f); }
+		static void ToNormal(uint32_t bits1, uint32_t bits2, float& first, float& second)
+		{
+			//1 - u is in (0, 1], log can't get 0
+			const float radius = sqrtf(-2.f * logf(1.f - ToFloat(bits1)));
+			const float angle = 6.28318531f * ToFloat(bits2);
+			first = radius * cosf(angle);
+			second = radius * sinf(angle);
+		}
+
+	private:
+		static uint64_t SplitMix64(uint64_t& state)
+		{
+			uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+			return z ^ (z >> 31);
+		}
+
+		uint32_t m_State[4]{};
+		float m_SpareNormal{};
+		bool m_HasSpareNormal{ false };
+	};
+
+	//Lanes streams of xoshiro128** next to each other, for filling big buffers (samples of a planner).
+	//The lane loops have no dependencies between the lanes, so the compiler vectorizes them.
+	//Value i of a fill comes from lane i % Lanes, so the numbers only depend on the generator it was split from.
+	class RandomStreams final
+	{
+	public:
+		static constexpr int Lanes{ 8 };
+
+		/*! Lane i starts at random jumped i times, random itself is not changed */
+		explicit RandomStreams(const Random& random);
+
+		/*! [min, max) */
+		void FillUniform(float* pValues, size_t count, float min = 0.f, float max = 1.f);
+		/*! Normal distribution, Box-Muller on the values of two blocks */
+		void FillNormal(float* pValues, size_t count, float mean = 0.f, float deviation = 1.f);
+
+	private:
+		uint32_t m_State[4][Lanes]{};
+	};
+
+	/*! Generator of the calling thread, used by randomInt, randomFloat, randomVector2 and FMatrix::Randomize.
+		It is stream SetThreadRandomStream(stream) of the last SeedRandom seed, so it doesn't depend on the thread timing */
+	Random& GetThreadRandom();
+	/*! Gives the calling thread its own stream of the seed, call it with the worker index (or bot id) before the thread
+		draws numbers. Threads that don't call it use stream 0, like the main thread, and so get the same numbers */
+	void SetThreadRandomStream(uint32_t stream);
+	/*! Reseeds the generators of all threads, every thread starts over at its own stream of seed when it next draws a number.
+		Call it while no other thread is drawing numbers */
+	void SeedRandom(uint64_t seed);
+}
+#endif
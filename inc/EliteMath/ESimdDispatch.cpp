@@ -0,0 +1,485 @@
+/*=============================================================================*/
+// Copyright 2021-2022 Elite Engine
+/*=============================================================================*/
+// ESimdDispatch.cpp: CPU detection, kernel binding and self test of the batch kernels
+/*=============================================================================*/
+#include "stdafx.h"
+#include "ESimdDispatch.h"
+#include "ESimdKernels.h"
+#include "EliteGeometry/EGeometry2DUtilities.h"
+#include <chrono>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__i386__) || defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+using namespace Elite;
+
+namespace
+{
+#pragma region ScalarKernels
+	//The scalar level does nothing in bulk, the dispatcher does everything with the single functions
+	size_t DistancesSquaredScalar(float, float, const float*, size_t, float*) { return 0; }
+	size_t PointInTrianglesScalar(float, float, const TriangleSoA&, size_t, bool, uint8_t*) { return 0; }
+	size_t FindPointInTrianglesScalar(float, float, const TriangleSoA&, size_t, bool, int& index) { index = -1; return 0; }
+	size_t IsPointInTrianglesScalar(float, float, const TriangleSoA&, size_t, uint8_t*) { return 0; }
+	size_t SegmentCirclesScalar(float, float, float, float, const CircleSoA&, size_t, uint8_t*) { return 0; }
+	size_t SegmentAnyCircleScalar(float, float, float, float, const CircleSoA&, size_t, bool& isHit) { isHit = false; return 0; }
+	size_t SegmentAnyBoxScalar(float, float, float, float, const BoxSoA&, size_t, bool& isHit) { isHit = false; return 0; }
+	size_t SinCosScalar(const float*, size_t, float*, float*) { return 0; }
+	size_t Atan2Scalar(const float*, const float*, size_t, float*) { return 0; }
+	int MatrixMultiplyScalar(const float*, int, const float*, int, float*, int, int, int, int) { return 0; }
+	size_t TransformScalar(const float*, const float*, size_t, bool, float*) { return 0; }
+	//Has to sum in the same lanes as the packs
+	size_t DotScalar(const float* pA, const float* pB, size_t count, float& dot)
+	{
+		float lanes[SimdKernels::DotLanes]{};
+		size_t i = 0;
+		for (; i + SimdKernels::DotLanes <= count; i += SimdKernels::DotLanes)
+		{
+			for (size_t lane = 0; lane < SimdKernels::DotLanes; ++lane)
+				lanes[lane] += pA[i + lane] * pB[i + lane];
+		}
+		dot = SimdKernels::ReduceDotLanes<float>(lanes);
+		return i;
+	}
+
+	constexpr SimdBulkKernels ScalarKernels{ &DistancesSquaredScalar, &PointInTrianglesScalar, &FindPointInTrianglesScalar,
+		&IsPointInTrianglesScalar, &SegmentCirclesScalar, &SegmentAnyCircleScalar, &SegmentAnyBoxScalar, &SinCosScalar, &Atan2Scalar,
+		&MatrixMultiplyScalar, &DotScalar, &TransformScalar };
+#pragma endregion
+
+	//Constant initialized, so the kernels already work before InitializeSimd and during static initialization
+#ifdef ELITE_SIMD_SSE
+	SimdLevel g_SimdLevel{ SimdLevel::SSE2 };
+	SimdBulkKernels g_Kernels{ &SimdKernels::DistancesSquared<Floatx4>, &SimdKernels::PointInTriangles<Floatx4>,
+		&SimdKernels::FindPointInTriangles<Floatx4>, &SimdKernels::IsPointInTriangles<Floatx4>, &SimdKernels::SegmentCircles<Floatx4>,
+		&SimdKernels::SegmentAnyCircle<Floatx4>, &SimdKernels::SegmentAnyBox<Floatx4>, &SimdKernels::SinCos<Floatx4>,
+		&SimdKernels::Atan2<Floatx4>, &SimdKernels::MatrixMultiply<Floatx4>, &SimdKernels::Dot<Floatx4>, &SimdKernels::Transform<Floatx4> };
+#else
+	SimdLevel g_SimdLevel{ SimdLevel::Scalar };
+	SimdBulkKernels g_Kernels{ ScalarKernels };
+#endif
+
+#pragma region CpuDetection
+	bool GetCpuid(unsigned int leaf, unsigned int subLeaf, unsigned int registers[4])
+	{
+#if defined(_MSC_VER)
+		int values[4]{};
+		__cpuid(values, 0);
+		if (static_cast<unsigned int>(values[0]) < leaf)
+			return false;
+		__cpuidex(values, static_cast<int>(leaf), static_cast<int>(subLeaf));
+		for (int i = 0; i < 4; ++i)
+			registers[i] = static_cast<unsigned int>(values[i]);
+		return true;
+#elif defined(__i386__) || defined(__x86_64__)
+		if (__get_cpuid_max(0, nullptr) < leaf)
+			return false;
+		__cpuid_count(leaf, subLeaf, registers[0], registers[1], registers[2], registers[3]);
+		return true;
+#else
+		(void)leaf; (void)subLeaf; (void)registers;
+		return false;
+#endif
+	}
+
+	//Which register states the OS saves on a context switch, only valid when the CPU has OSXSAVE
+	unsigned long long GetXcr0()
+	{
+#if defined(_MSC_VER)
+		return _xgetbv(0);
+#elif defined(__i386__) || defined(__x86_64__)
+		unsigned int eax, edx;
+		__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return (static_cast<unsigned long long>(edx) << 32) | eax;
+#else
+		return 0;
+#endif
+	}
+#pragma endregion
+
+#pragma region SelfTest
+	//Grid coordinates, so points end up exactly on edges and corners, plus degenerate triangles and segments
+	struct SelfTestData
+	{
+		std::vector<Vector2> points{};
+		std::vector<float> x1, y1, x2, y2, x3, y3;
+		std::vector<float> centerX, centerY, radius;
+		std::vector<float> minX, minY, maxX, maxY;
+		std::vector<float> matrixA, matrixB;
+
+		TriangleSoA GetTriangles() const { return { x1.data(), y1.data(), x2.data(), y2.data(), x3.data(), y3.data() }; }
+		CircleSoA GetCircles() const { return { centerX.data(), centerY.data(), radius.data() }; }
+		BoxSoA GetBoxes() const { return { minX.data(), minY.data(), maxX.data(), maxY.data() }; }
+	};
+
+	constexpr size_t SelfTestCount{ 37 }; //not a multiple of any width, so the tails are tested too
+	//Big enough for more than one block of the matrix multiply, A and C have extra rows to test the strides
+	constexpr int SelfTestRows{ 19 }, SelfTestInner{ 300 }, SelfTestColumns{ 133 };
+	constexpr int SelfTestStrideA{ SelfTestRows + 3 }, SelfTestStrideC{ SelfTestRows + 1 };
+
+	SelfTestData CreateSelfTestData()
+	{
+		std::mt19937 generator{ 5489u };
+		std::uniform_int_distribution<int> coordinate{ -4, 4 };
+		std::uniform_real_distribution<float> value{ -10.f, 10.f };
+		const auto gridValue = [&]() { return static_cast<float>(coordinate(generator)); };
+
+		SelfTestData data{};
+		for (size_t i = 0; i < SelfTestCount; ++i)
+		{
+			data.points.push_back({ value(generator), value(generator) });
+
+			const Vector2 p1{ gridValue(), gridValue() };
+			const Vector2 p2{ i % 9 == 0 ? p1 : Vector2{ gridValue(), gridValue() } };
+			const Vector2 p3{ gridValue(), gridValue() };
+			data.x1.push_back(p1.x); data.y1.push_back(p1.y);
+			data.x2.push_back(p2.x); data.y2.push_back(p2.y);
+			data.x3.push_back(p3.x); data.y3.push_back(p3.y);
+
+			data.centerX.push_back(gridValue());
+			data.centerY.push_back(gridValue());
+			data.radius.push_back(i % 7 == 0 ? 0.f : value(generator) * 0.2f);
+
+			const float boxX{ gridValue() }, boxY{ gridValue() };
+			data.minX.push_back(boxX); data.maxX.push_back(boxX + 0.25f + (i % 3));
+			data.minY.push_back(boxY); data.maxY.push_back(boxY + 0.25f + (i % 2));
+		}
+		for (int i = 0; i < SelfTestStrideA * SelfTestInner; ++i)
+			data.matrixA.push_back(value(generator));
+		for (int i = 0; i < SelfTestInner * SelfTestColumns; ++i)
+			data.matrixB.push_back(value(generator));
+		return data;
+	}
+
+	bool IsSameKernelResult(const char* pKernel, bool isSame)
+	{
+		if (!isSame)
+			printf("\n--SIMD self test: %s differs from the scalar version at the %s level!\n", pKernel, GetSimdLevelName(g_SimdLevel));
+		return isSame;
+	}
+
+	//Runs the bound kernels and the scalar level on the same input and compares the bits of the results
+	bool RunSelfTest(const SelfTestData& data)
+	{
+		const SimdBulkKernels testedKernels{ g_Kernels };
+		const TriangleSoA triangles{ data.GetTriangles() };
+		const CircleSoA circles{ data.GetCircles() };
+		const BoxSoA boxes{ data.GetBoxes() };
+		const size_t count{ SelfTestCount };
+		bool isOk{ true };
+
+		//The scalar results, from the same public functions with the scalar kernels bound
+		std::vector<float> distances[2]{ std::vector<float>(count), std::vector<float>(count) };
+		std::vector<uint8_t> inTriangle[2]{ std::vector<uint8_t>(count * 2 * count), std::vector<uint8_t>(count * 2 * count) };
+		std::vector<uint8_t> isInTriangle[2]{ std::vector<uint8_t>(count * count), std::vector<uint8_t>(count * count) };
+		std::vector<int> found[2]{};
+		std::vector<uint8_t> segmentCircles[2]{ std::vector<uint8_t>(count * count), std::vector<uint8_t>(count * count) };
+		std::vector<uint8_t> anyHit[2]{};
+		std::vector<float> trigonometry[2]{ std::vector<float>(3 * count), std::vector<float>(3 * count) };
+		std::vector<float> product[2]{ std::vector<float>(SelfTestStrideC * SelfTestColumns), std::vector<float>(SelfTestStrideC * SelfTestColumns) };
+		float dot[2]{};
+		std::vector<Vector2> transformed[2]{ std::vector<Vector2>(2 * count), std::vector<Vector2>(2 * count) };
+		const float matrix[6]{ data.points[0].x, data.points[0].y, data.points[1].x, data.points[1].y, data.points[2].x, data.points[2].y };
+
+		for (int pass = 0; pass < 2; ++pass)
+		{
+			g_Kernels = pass == 0 ? ScalarKernels : testedKernels;
+
+			Simd::DistancesSquared(data.points[0], data.points.data(), count, distances[pass].data());
+			for (size_t p = 0; p < count; ++p)
+			{
+				//Triangle corners too, those are on the edges of other triangles
+				const Vector2 point{ p % 2 == 0 ? data.points[p] : Vector2{ data.x3[p], data.y3[p] } };
+				Simd::PointInTriangles(point, triangles, count, false, &inTriangle[pass][2 * p * count]);
+				Simd::PointInTriangles(point, triangles, count, true, &inTriangle[pass][(2 * p + 1) * count]);
+				Simd::IsPointInTriangles(point, triangles, count, &isInTriangle[pass][p * count]);
+				found[pass].push_back(Simd::FindPointInTriangles(point, triangles, count, p % 3 == 0));
+
+				const Vector2 end{ p % 5 == 0 ? point : data.points[(p + 1) % count] };
+				Simd::SegmentCircles(point, end, circles, count, &segmentCircles[pass][p * count]);
+				anyHit[pass].push_back(Simd::SegmentAnyCircle(point, end, circles, p));
+
+				Vector2 direction{ end - point };
+				direction.x = direction.x == 0.f ? 1e-30f : direction.x;
+				direction.y = direction.y == 0.f ? 1e-30f : direction.y;
+				anyHit[pass].push_back(Simd::SegmentAnyBox(point, { 1.f / direction.x, 1.f / direction.y }, boxes, p));
+			}
+			Simd::SinCos(data.matrixA.data(), count, &trigonometry[pass][0], &trigonometry[pass][count]);
+			Simd::Atan2(data.centerY.data(), data.centerX.data(), count, &trigonometry[pass][2 * count]);
+			Simd::MatrixMultiply(data.matrixA.data(), SelfTestStrideA, data.matrixB.data(), SelfTestInner, product[pass].data(), SelfTestStrideC,
+				SelfTestRows, SelfTestInner, SelfTestColumns);
+			dot[pass] = Simd::Dot(data.matrixA.data() + 1, data.matrixB.data(), data.matrixA.size() - 1);
+			Simd::Transform(matrix, data.points.data(), count, true, &transformed[pass][0]);
+			Simd::Transform(matrix, data.points.data(), count, false, &transformed[pass][count]);
+		}
+		g_Kernels = testedKernels;
+
+		isOk &= IsSameKernelResult("DistancesSquared", memcmp(distances[0].data(), distances[1].data(), count * sizeof(float)) == 0);
+		isOk &= IsSameKernelResult("PointInTriangles", inTriangle[0] == inTriangle[1]);
+		isOk &= IsSameKernelResult("IsPointInTriangles", isInTriangle[0] == isInTriangle[1]);
+		isOk &= IsSameKernelResult("FindPointInTriangles", found[0] == found[1]);
+		isOk &= IsSameKernelResult("SegmentCircles", segmentCircles[0] == segmentCircles[1]);
+		isOk &= IsSameKernelResult("SegmentAnyCircle/SegmentAnyBox", anyHit[0] == anyHit[1]);
+		isOk &= IsSameKernelResult("SinCos/Atan2", memcmp(trigonometry[0].data(), trigonometry[1].data(), trigonometry[0].size() * sizeof(float)) == 0);
+		isOk &= IsSameKernelResult("MatrixMultiply", memcmp(product[0].data(), product[1].data(), product[0].size() * sizeof(float)) == 0);
+		isOk &= IsSameKernelResult("Dot", memcmp(&dot[0], &dot[1], sizeof(float)) == 0);
+		isOk &= IsSameKernelResult("Transform", memcmp(transformed[0].data(), transformed[1].data(), transformed[0].size() * sizeof(Vector2)) == 0);
+		return isOk;
+	}
+
+	//Microseconds for a point against every triangle of the test data, a lot of times
+	float MeasurePointInTriangles(const SelfTestData& data)
+	{
+		constexpr int repeats{ 2000 };
+		std::vector<uint8_t> results(SelfTestCount);
+		const TriangleSoA triangles{ data.GetTriangles() };
+		int inside{};
+
+		const auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < repeats; ++i)
+		{
+			Simd::PointInTriangles(data.points[i % SelfTestCount], triangles, SelfTestCount, true, results.data());
+			inside += results[i % SelfTestCount];
+		}
+		const auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<float, std::micro>(end - start).count() + (inside < 0 ? 1.f : 0.f); //keep the loop
+	}
+#pragma endregion
+}
+
+#pragma region Kernels
+void Simd::DistancesSquared(const Vector2& point, const Vector2* pPoints, size_t count, float* pResults)
+{
+	size_t i = g_Kernels.pDistancesSquared(point.x, point.y, reinterpret_cast<const float*>(pPoints), count, pResults);
+	for (; i < count; ++i)
+		pResults[i] = Elite::DistanceSquared(point, pPoints[i]);
+}
+
+void Simd::PointInTriangles(const Vector2& point, const TriangleSoA& triangles, size_t count, bool onLineAllowed, uint8_t* pResults)
+{
+	size_t i = g_Kernels.pPointInTriangles(point.x, point.y, triangles, count, onLineAllowed, pResults);
+	for (; i < count; ++i)
+	{
+		pResults[i] = PointInTriangle(point, { triangles.x1[i], triangles.y1[i] }, { triangles.x2[i], triangles.y2[i] },
+			{ triangles.x3[i], triangles.y3[i] }, onLineAllowed);
+	}
+}
+
+int Simd::FindPointInTriangles(const Vector2& point, const TriangleSoA& triangles, size_t count, bool onLineAllowed)
+{
+	int index{ -1 };
+	size_t i = g_Kernels.pFindPointInTriangles(point.x, point.y, triangles, count, onLineAllowed, index);
+	if (index >= 0)
+		return index;
+	for (; i < count; ++i)
+	{
+		if (PointInTriangle(point, { triangles.x1[i], triangles.y1[i] }, { triangles.x2[i], triangles.y2[i] },
+			{ triangles.x3[i], triangles.y3[i] }, onLineAllowed))
+			return static_cast<int>(i);
+	}
+	return -1;
+}
+
+void Simd::IsPointInTriangles(const Vector2& point, const TriangleSoA& triangles, size_t count, uint8_t* pResults)
+{
+	size_t i = g_Kernels.pIsPointInTriangles(point.x, point.y, triangles, count, pResults);
+	for (; i < count; ++i)
+	{
+		pResults[i] = IsPointInTriangle(point, { triangles.x1[i], triangles.y1[i] }, { triangles.x2[i], triangles.y2[i] },
+			{ triangles.x3[i], triangles.y3[i] });
+	}
+}
+
+void Simd::SegmentCircles(const Vector2& start, const Vector2& end, const CircleSoA& circles, size_t count, uint8_t* pResults)
+{
+	size_t i = g_Kernels.pSegmentCircles(start.x, start.y, end.x, end.y, circles, count, pResults);
+	for (; i < count; ++i)
+		pResults[i] = IsSegmentIntersectingWithCircle(start, end, { circles.centerX[i], circles.centerY[i] }, circles.radius[i]);
+}
+
+bool Simd::SegmentAnyCircle(const Vector2& start, const Vector2& end, const CircleSoA& circles, size_t count)
+{
+	bool isHit{};
+	size_t i = g_Kernels.pSegmentAnyCircle(start.x, start.y, end.x, end.y, circles, count, isHit);
+	if (isHit)
+		return true;
+	for (; i < count; ++i)
+	{
+		if (IsSegmentIntersectingWithCircle(start, end, { circles.centerX[i], circles.centerY[i] }, circles.radius[i]))
+			return true;
+	}
+	return false;
+}
+
+bool Simd::SegmentAnyBox(const Vector2& from, const Vector2& inverseDirection, const BoxSoA& boxes, size_t count)
+{
+	bool isHit{};
+	size_t i = g_Kernels.pSegmentAnyBox(from.x, from.y, inverseDirection.x, inverseDirection.y, boxes, count, isHit);
+	if (isHit)
+		return true;
+	for (; i < count; ++i)
+	{
+		const float tx1{ (boxes.minX[i] - from.x) * inverseDirection.x };
+		const float tx2{ (boxes.maxX[i] - from.x) * inverseDirection.x };
+		const float ty1{ (boxes.minY[i] - from.y) * inverseDirection.y };
+		const float ty2{ (boxes.maxY[i] - from.y) * inverseDirection.y };
+		const float tNear{ max(min(tx1, tx2), min(ty1, ty2)) };
+		const float tFar{ min(max(tx1, tx2), max(ty1, ty2)) };
+		if (tNear > 0.f && tNear <= tFar && tFar < 1.f)
+			return true;
+	}
+	return false;
+}
+
+void Simd::SinCos(const float* pAngles, size_t count, float* pSines, float* pCosines)
+{
+	size_t i = g_Kernels.pSinCos(pAngles, count, pSines, pCosines);
+	for (; i < count; ++i)
+	{
+		pSines[i] = FastSin(pAngles[i]);
+		pCosines[i] = FastCos(pAngles[i]);
+	}
+}
+
+void Simd::Atan2(const float* pY, const float* pX, size_t count, float* pResults)
+{
+	size_t i = g_Kernels.pAtan2(pY, pX, count, pResults);
+	for (; i < count; ++i)
+		pResults[i] = FastAtan2(pY[i], pX[i]);
+}
+
+void Simd::MatrixMultiply(const float* pA, int strideA, const float* pB, int strideB, float* pC, int strideC, int rows, int inner, int columns)
+{
+	const int packedRows = g_Kernels.pMatrixMultiply(pA, strideA, pB, strideB, pC, strideC, rows, inner, columns);
+	for (int c = 0; c < columns; ++c)
+	{
+		//Without inner the kernels don't touch C, the loop below zeroes it
+		for (int r = inner > 0 ? packedRows : 0; r < rows; ++r)
+		{
+			float sum = 0;
+			for (int k = 0; k < inner; ++k)
+				sum += pA[k * strideA + r] * pB[c * strideB + k];
+			pC[c * strideC + r] = sum;
+		}
+	}
+}
+
+float Simd::Dot(const float* pA, const float* pB, size_t count)
+{
+	float dot{};
+	size_t i = g_Kernels.pDot(pA, pB, count, dot);
+	for (; i < count; ++i)
+		dot += pA[i] * pB[i];
+	return dot;
+}
+
+void Simd::Transform(const float* pMatrix, const Vector2* pPoints, size_t count, bool isPoint, Vector2* pResults)
+{
+	size_t i = g_Kernels.pTransform(pMatrix, &pPoints->x, count, isPoint, &pResults->x);
+	for (; i < count; ++i)
+	{
+		const Vector2 point{ pPoints[i] };
+		pResults[i] = { point.x * pMatrix[0] + point.y * pMatrix[2], point.x * pMatrix[1] + point.y * pMatrix[3] };
+		if (isPoint)
+			pResults[i] += Vector2{ pMatrix[4], pMatrix[5] };
+	}
+}
+#pragma endregion
+
+#pragma region Dispatch
+SimdLevel Elite::DetectSimdLevel()
+{
+	unsigned int features[4]{};
+	if (!GetCpuid(1, 0, features))
+		return SimdLevel::Scalar;
+
+	constexpr unsigned int sse2Bit{ 1u << 26 }, osxsaveBit{ 1u << 27 }, avxBit{ 1u << 28 }, avx2Bit{ 1u << 5 };
+	const bool hasSse2{ (features[3] & sse2Bit) != 0 };
+	if (!hasSse2)
+		return SimdLevel::Scalar;
+
+	//AVX needs the OS to save the ymm registers as well
+	const bool hasAvx{ (features[2] & osxsaveBit) != 0 && (features[2] & avxBit) != 0 && (GetXcr0() & 0x6) == 0x6 };
+	unsigned int extendedFeatures[4]{};
+	if (hasAvx && GetCpuid(7, 0, extendedFeatures) && (extendedFeatures[1] & avx2Bit) != 0)
+		return SimdLevel::AVX2;
+	return SimdLevel::SSE2;
+}
+
+SimdLevel Elite::GetSimdLevel()
+{
+	return g_SimdLevel;
+}
+
+const char* Elite::GetSimdLevelName(SimdLevel level)
+{
+	switch (level)
+	{
+	case SimdLevel::SSE2: return "SSE2";
+	case SimdLevel::AVX2: return "AVX2";
+	default: return "Scalar";
+	}
+}
+
+bool Elite::SetSimdLevel(SimdLevel level)
+{
+	if (static_cast<int>(level) > static_cast<int>(DetectSimdLevel()))
+		return false;
+
+	SimdBulkKernels kernels{ ScalarKernels };
+	switch (level)
+	{
+	case SimdLevel::Scalar:
+		break;
+	case SimdLevel::SSE2:
+#ifdef ELITE_SIMD_SSE
+		kernels = SimdKernels::GetKernels<Floatx4>();
+		break;
+#else
+		return false;
+#endif
+	case SimdLevel::AVX2:
+		if (!GetAvx2BulkKernels(kernels))
+			return false;
+		break;
+	}
+
+	g_Kernels = kernels;
+	g_SimdLevel = level;
+	return true;
+}
+
+bool Elite::RunSimdSelfTest()
+{
+	return RunSelfTest(CreateSelfTestData());
+}
+
+void Elite::InitializeSimd()
+{
+	const SimdLevel detectedLevel{ DetectSimdLevel() };
+	const SelfTestData data{ CreateSelfTestData() };
+
+	//Fall back a level when a level isn't built in or gives other results than the scalar functions
+	int level{ static_cast<int>(detectedLevel) };
+	for (; level > 0; --level)
+	{
+		if (SetSimdLevel(static_cast<SimdLevel>(level)) && RunSelfTest(data))
+			break;
+	}
+	if (level == 0)
+		SetSimdLevel(SimdLevel::Scalar);
+
+	const float simdTime{ MeasurePointInTriangles(data) };
+	SetSimdLevel(SimdLevel::Scalar);
+	const float scalarTime{ MeasurePointInTriangles(data) };
+	SetSimdLevel(static_cast<SimdLevel>(level));
+
+	printf("SIMD kernels: %s (CPU supports %s), point in triangles %.1fx the scalar speed\n",
+		GetSimdLevelName(g_SimdLevel), GetSimdLevelName(detectedLevel), simdTime > 0.f ? scalarTime / simdTime : 1.f);
+}
+#pragma endregion
@@ -0,0 +1,80 @@
+/*=============================================================================*/
+// Copyright 2021-2022 Elite Engine
+/*=============================================================================*/
+// ESimdDispatch.h: Batch math and geometry kernels, bound at runtime to the best instruction set the CPU has
+/*=============================================================================*/
+#ifndef ELITE_MATH_SIMD_DISPATCH
+#define	ELITE_MATH_SIMD_DISPATCH
+
+namespace Elite
+{
+	enum class SimdLevel
+	{
+		Scalar = 0,
+		SSE2 = 1,
+		AVX2 = 2
+	};
+
+	/*! Structure of arrays views, every array has at least count elements */
+	struct TriangleSoA
+	{
+		const float* x1; const float* y1;
+		const float* x2; const float* y2;
+		const float* x3; const float* y3;
+	};
+	struct CircleSoA
+	{
+		const float* centerX; const float* centerY;
+		const float* radius;
+	};
+	struct BoxSoA
+	{
+		const float* minX; const float* minY;
+		const float* maxX; const float* maxY;
+	};
+
+	//Every level does the math in the same order as the scalar functions, so they all give exactly the same results.
+	//Until InitializeSimd picks the best level they run at SSE2, or Scalar when the project is built without SSE.
+	namespace Simd
+	{
+		/*! DistanceSquared(point, points[i]) */
+		void DistancesSquared(const Vector2& point, const Vector2* pPoints, size_t count, float* pResults);
+		/*! PointInTriangle(point, p1, p2, p3, onLineAllowed) */
+		void PointInTriangles(const Vector2& point, const TriangleSoA& triangles, size_t count, bool onLineAllowed, uint8_t* pResults);
+		/*! Index of the first triangle PointInTriangle is true for, -1 if there is none */
+		int FindPointInTriangles(const Vector2& point, const TriangleSoA& triangles, size_t count, bool onLineAllowed);
+		/*! IsPointInTriangle(point, p1, p2, p3) */
+		void IsPointInTriangles(const Vector2& point, const TriangleSoA& triangles, size_t count, uint8_t* pResults);
+		/*! IsSegmentIntersectingWithCircle(start, end, center[i], radius[i]) */
+		void SegmentCircles(const Vector2& start, const Vector2& end, const CircleSoA& circles, size_t count, uint8_t* pResults);
+		/*! True when the segment intersects any of the circles */
+		bool SegmentAnyCircle(const Vector2& start, const Vector2& end, const CircleSoA& circles, size_t count);
+		/*! Slab test of from + t * direction, t in [0, 1], against the boxes. Boxes that hold from or from + direction are skipped.
+			Give the inverse of the direction (no zero components) */
+		bool SegmentAnyBox(const Vector2& from, const Vector2& inverseDirection, const BoxSoA& boxes, size_t count);
+		/*! FastSin and FastCos of every angle */
+		void SinCos(const float* pAngles, size_t count, float* pSines, float* pCosines);
+		/*! FastAtan2(y[i], x[i]) */
+		void Atan2(const float* pY, const float* pX, size_t count, float* pResults);
+		/*! C = A * B, column major (like FMatrix), A is rows x inner, B is inner x columns.
+		The strides are the distance between two columns, every element sums its products in order (like a plain loop). */
+		void MatrixMultiply(const float* pA, int strideA, const float* pB, int strideB, float* pC, int strideC, int rows, int inner, int columns);
+		/*! Sum of a[i] * b[i], summed in 8 interleaved lanes. Rounds differently than a plain loop, but the same at every level */
+		float Dot(const float* pA, const float* pB, size_t count);
+		/*! Matrix2x3::Transform of every point, pMatrix is the 6 floats of the matrix (dirX, dirY, orig).
+		Vectors (isPoint false) skip the translation. pResults can be pPoints, otherwise they can't overlap */
+		void Transform(const float* pMatrix, const Vector2* pPoints, size_t count, bool isPoint, Vector2* pResults);
+	}
+
+	/*! Best level the CPU and the OS support */
+	SimdLevel DetectSimdLevel();
+	SimdLevel GetSimdLevel();
+	const char* GetSimdLevelName(SimdLevel level);
+	/*! Binds the kernels of the level, false when the CPU doesn't support it or it isn't compiled in */
+	bool SetSimdLevel(SimdLevel level);
+	/*! Compares the bound kernels with the scalar functions on test data */
+	bool RunSimdSelfTest();
+	/*! Detects the CPU, binds the best level that passes the self test and logs which one is active. Call once at startup */
+	void InitializeSimd();
+}
+#endif
@@ -0,0 +1,448 @@
+/*=============================================================================*/
+// Copyright 2021-2022 Elite Engine
+/*=============================================================================*/
+// ESimdKernels.h: Batch kernels of ESimdDispatch, written once for every float pack
+// Only included by the dispatch translation units, every TU instantiates them with its own pack type.
+/*=============================================================================*/
+#ifndef ELITE_MATH_SIMD_KERNELS
+#define	ELITE_MATH_SIMD_KERNELS
+
+namespace Elite
+{
+	//Kernels only do whole packs and return how many elements they did, the dispatcher does the rest with the scalar functions.
+	//Keep the operations in the same order as the scalar functions, that is what keeps the levels exactly equal.
+	struct SimdBulkKernels
+	{
+		size_t(*pDistancesSquared)(float px, float py, const float* pPoints, size_t count, float* pResults);
+		size_t(*pPointInTriangles)(float px, float py, const TriangleSoA& triangles, size_t count, bool onLineAllowed, uint8_t* pResults);
+		size_t(*pFindPointInTriangles)(float px, float py, const TriangleSoA& triangles, size_t count, bool onLineAllowed, int& index);
+		size_t(*pIsPointInTriangles)(float px, float py, const TriangleSoA& triangles, size_t count, uint8_t* pResults);
+		size_t(*pSegmentCircles)(float sx, float sy, float ex, float ey, const CircleSoA& circles, size_t count, uint8_t* pResults);
+		size_t(*pSegmentAnyCircle)(float sx, float sy, float ex, float ey, const CircleSoA& circles, size_t count, bool& isHit);
+		size_t(*pSegmentAnyBox)(float fx, float fy, float ix, float iy, const BoxSoA& boxes, size_t count, bool& isHit);
+		size_t(*pSinCos)(const float* pAngles, size_t count, float* pSines, float* pCosines);
+		size_t(*pAtan2)(const float* pY, const float* pX, size_t count, float* pResults);
+		int(*pMatrixMultiply)(const float* pA, int strideA, const float* pB, int strideB, float* pC, int strideC, int rows, int inner, int columns);
+		size_t(*pDot)(const float* pA, const float* pB, size_t count, float& dot);
+		size_t(*pTransform)(const float* pMatrix, const float* pPoints, size_t count, bool isPoint, float* pResults);
+	};
+
+	namespace SimdKernels
+	{
+		template<typename Pack>
+		inline void StoreBits(int bits, uint8_t* pResults)
+		{
+			for (size_t lane = 0; lane < Pack::Width; ++lane)
+				pResults[lane] = static_cast<uint8_t>((bits >> lane) & 1);
+		}
+
+		//DistanceSquared(point, points[i]), the points are interleaved x y
+		template<typename Pack>
+		size_t DistancesSquared(float px, float py, const float* pPoints, size_t count, float* pResults)
+		{
+			const Pack pointX(px), pointY(py);
+			size_t i = 0;
+			for (; i + Pack::Width <= count; i += Pack::Width)
+			{
+				Pack x, y;
+				Pack::LoadInterleaved(pPoints + 2 * i, x, y);
+				const Pack dx = x - pointX;
+				const Pack dy = y - pointY;
+				(dx * dx + dy * dy).Store(pResults + i);
+			}
+			return i;
+		}
+
+		//DistanceSquarePointToLine per lane
+		template<typename Pack>
+		inline Pack DistanceSquarePointToLines(const Pack& p1x, const Pack& p1y, const Pack& p2x, const Pack& p2y, const Pack& px, const Pack& py)
+		{
+			const Pack p1p2x = p2x - p1x, p1p2y = p2y - p1y;
+			const Pack p1p2_squareDistance = p1p2x * p1p2x + p1p2y * p1p2y;
+			const Pack dp = ((px - p1x) * p1p2x + (py - p1y) * p1p2y) / p1p2_squareDistance;
+
+			const Pack beforeX = px - p1x, beforeY = py - p1y;
+			const Pack beforeStart = beforeX * beforeX + beforeY * beforeY;
+			const Pack pp1x = p1x - px, pp1y = p1y - py;
+			const Pack onSegment = (pp1x * pp1x + pp1y * pp1y) - dp * dp * p1p2_squareDistance;
+			const Pack afterX = px - p2x, afterY = py - p2y;
+			const Pack afterEnd = afterX * afterX + afterY * afterY;
+
+			//dp < 0 ? beforeStart : (dp <= 1 ? onSegment : afterEnd), NaN ends up in afterEnd like in the single version
+			const Pack notBefore = Select(dp <= Pack(1.f), onSegment, afterEnd);
+			return Select(dp < Pack(0.f), beforeStart, notBefore);
+		}
+
+		//PointInTriangle of the Width triangles at index, returns the lane bits
+		template<typename Pack>
+		inline int PointInTrianglesPack(const Pack& px, const Pack& py, const TriangleSoA& triangles, size_t index, bool onLineAllowed)
+		{
+			const int allBits = (1 << Pack::Width) - 1;
+			const Pack tipX = Pack::Load(triangles.x1 + index), tipY = Pack::Load(triangles.y1 + index);
+			const Pack prevX = Pack::Load(triangles.x2 + index), prevY = Pack::Load(triangles.y2 + index);
+			const Pack nextX = Pack::Load(triangles.x3 + index), nextY = Pack::Load(triangles.y3 + index);
+
+			//Bounding box test
+			const Pack epsilon(FLT_EPSILON);
+			const Pack xMin = Min(tipX, Min(prevX, nextX)) - epsilon;
+			const Pack xMax = Max(tipX, Max(prevX, nextX)) + epsilon;
+			const Pack yMin = Min(tipY, Min(prevY, nextY)) - epsilon;
+			const Pack yMax = Max(tipY, Max(prevY, nextY)) + epsilon;
+			const int boxBits = ~((px < xMin) | (xMax < px) | (py < yMin) | (yMax < py)).GetBits() & allBits;
+			if (boxBits == 0)
+				return 0;
+
+			//Barycentric coordinates
+			const Pack v0x = prevX - tipX, v0y = prevY - tipY;
+			const Pack v1x = nextX - tipX, v1y = nextY - tipY;
+			const Pack v2x = px - tipX, v2y = py - tipY;
+
+			const Pack dot00 = v0x * v0x + v0y * v0y;
+			const Pack dot01 = v0x * v1x + v0y * v1y;
+			const Pack dot02 = v0x * v2x + v0y * v2y;
+			const Pack dot11 = v1x * v1x + v1y * v1y;
+			const Pack dot12 = v1x * v2x + v1y * v2y;
+
+			const Pack zero(0.f), one(1.f);
+			const Pack invDenom = one / (dot00 * dot11 - dot01 * dot01);
+			const Pack u = (dot11 * dot02 - dot01 * dot12) * invDenom;
+			const Pack v = (dot00 * dot12 - dot01 * dot02) * invDenom;
+
+			int bits = ~((u < zero) | (v < zero) | (u > one) | (v > one) | ((u + v) > one)).GetBits() & boxBits;
+			if (!onLineAllowed || bits == boxBits)
+				return bits;
+
+			//Points on the edges that the barycentric coordinates miss
+			const Pack lineEpsilon(FLT_EPSILON);
+			const int onLineBits = ((DistanceSquarePointToLines(tipX, tipY, nextX, nextY, px, py) <= lineEpsilon) |
+				(DistanceSquarePointToLines(nextX, nextY, prevX, prevY, px, py) <= lineEpsilon) |
+				(DistanceSquarePointToLines(prevX, prevY, tipX, tipY, px, py) <= lineEpsilon)).GetBits();
+			return bits | (onLineBits & boxBits);
+		}
+
+		template<typename Pack>
+		size_t PointInTriangles(float px, float py, const TriangleSoA& triangles, size_t count, bool onLineAllowed, uint8_t* pResults)
+		{
+			const Pack pointX(px), pointY(py);
+			size_t i = 0;
+			for (; i + Pack::Width <= count; i += Pack::Width)
+				StoreBits<Pack>(PointInTrianglesPack(pointX, pointY, triangles, i, onLineAllowed), pResults + i);
+			return i;
+		}
+
+		template<typename Pack>
+		size_t FindPointInTriangles(float px, float py, const TriangleSoA& triangles, size_t count, bool onLineAllowed, int& index)
+		{
+			const Pack pointX(px), pointY(py);
+			index = -1;
+			size_t i = 0;
+			for (; i + Pack::Width <= count; i += Pack::Width)
+			{
+				const int bits = PointInTrianglesPack(pointX, pointY, triangles, i, onLineAllowed);
+				if (bits == 0)
+					continue;
+				for (size_t lane = 0; lane < Pack::Width; ++lane)
+				{
+					if (bits & (1 << lane))
+					{
+						index = static_cast<int>(i + lane);
+						return i + Pack::Width;
+					}
+				}
+			}
+			return i;
+		}
+
+		template<typename Pack>
+		size_t IsPointInTriangles(float px, float py, const TriangleSoA& triangles, size_t count, uint8_t* pResults)
+		{
+			const Pack pointX(px), pointY(py);
+			const Pack zero(0.f), one(1.f);
+			size_t i = 0;
+			for (; i + Pack::Width <= count; i += Pack::Width)
+			{
+				const Pack x1 = Pack::Load(triangles.x1 + i), y1 = Pack::Load(triangles.y1 + i);
+				const Pack x2 = Pack::Load(triangles.x2 + i), y2 = Pack::Load(triangles.y2 + i);
+				const Pack x3 = Pack::Load(triangles.x3 + i), y3 = Pack::Load(triangles.y3 + i);
+
+				const Pack y2y3 = y2 - y3;
+				const Pack x3x2 = x3 - x2;
+				const Pack pxx3 = pointX - x3;
+				const Pack pyy3 = pointY - y3;
+				const Pack denominator = y2y3 * (x1 - x3) + x3x2 * (y1 - y3);
+				const Pack a = (y2y3 * pxx3 + x3x2 * pyy3) / denominator;
+				const Pack b = ((y3 - y1) * pxx3 + (x1 - x3) * pyy3) / denominator;
+				const Pack c = one - a - b;
+
+				const int bits = ((zero <= a) & (a <= one) & (zero <= b) & (b <= one) & (zero <= c) & (c <= one)).GetBits();
+				StoreBits<Pack>(bits, pResults + i);
+			}
+			return i;
+		}
+
+		//IsSegmentIntersectingWithCircle of one segment against the Width circles at index, returns the lane bits
+		template<typename Pack>
+		inline int SegmentCirclesPack(const Pack& startX, const Pack& startY, const Pack& endX, const Pack& endY,
+			const Pack& lineX, const Pack& lineY, const Pack& vsq, const CircleSoA& circles, size_t index)
+		{
+			const Pack centerX = Pack::Load(circles.centerX + index);
+			const Pack centerY = Pack::Load(circles.centerY + index);
+			const Pack radius = Pack::Load(circles.radius + index);
+
+			//ProjectOnLineSegment without offset
+			const Pack proj = (centerX - startX) * lineX + (centerY - startY) * lineY;
+			const Pack scale = proj / vsq;
+			const Pack onSegmentX = startX + scale * lineX;
+			const Pack onSegmentY = startY + scale * lineY;
+
+			const typename Pack::Mask isBeforeStart = proj <= Pack(0.f);
+			const typename Pack::Mask isAfterEnd = proj >= vsq;
+			const Pack closestX = Select(isBeforeStart, startX, Select(isAfterEnd, endX, onSegmentX));
+			const Pack closestY = Select(isBeforeStart, startY, Select(isAfterEnd, endY, onSegmentY));
+
+			const Pack toCenterX = centerX - closestX;
+			const Pack toCenterY = centerY - closestY;
+			return (toCenterX * toCenterX + toCenterY * toCenterY <= radius * radius).GetBits();
+		}
+
+		template<typename Pack>
+		size_t SegmentCircles(float sx, float sy, float ex, float ey, const CircleSoA& circles, size_t count, uint8_t* pResults)
+		{
+			const float lx = ex - sx, ly = ey - sy;
+			const Pack startX(sx), startY(sy), endX(ex), endY(ey), lineX(lx), lineY(ly);
+			const Pack vsq(lx * lx + ly * ly);
+			size_t i = 0;
+			for (; i + Pack::Width <= count; i += Pack::Width)
+				StoreBits<Pack>(SegmentCirclesPack(startX, startY, endX, endY, lineX, lineY, vsq, circles, i), pResults + i);
+			return i;
+		}
+
+		template<typename Pack>
+		size_t SegmentAnyCircle(float sx, float sy, float ex, float ey, const CircleSoA& circles, size_t count, bool& isHit)
+		{
+			const float lx = ex - sx, ly = ey - sy;
+			const Pack startX(sx), startY(sy), endX(ex), endY(ey), lineX(lx), lineY(ly);
+			const Pack vsq(lx * lx + ly * ly);
+			isHit = false;
+			size_t i = 0;
+			for (; i + Pack::Width <= count; i += Pack::Width)
+			{
+				if (SegmentCirclesPack(startX, startY, endX, endY, lineX, lineY, vsq, circles, i) != 0)
+				{
+					isHit = true;
+					return i + Pack::Width;
+				}
+			}
+			return i;
+		}
+
+		//Slab test of from + t * direction, t in [0, 1]. A box that holds one of the ends doesn't count,
+		//so the line crosses it with tNear > 0 and tFar < 1
+		template<typename Pack>
+		size_t SegmentAnyBox(float fx, float fy, float ix, float iy, const BoxSoA& boxes, size_t count, bool& isHit)
+		{
+			const Pack fromX(fx), fromY(fy), inverseX(ix), inverseY(iy);
+			const Pack zero(0.f), one(1.f);
+			isHit = false;
+			size_t i = 0;
+			for (; i + Pack::Width <= count; i += Pack::Width)
+			{
+				const Pack tx1 = (Pack::Load(boxes.minX + i) - fromX) * inverseX;
+				const Pack tx2 = (Pack::Load(boxes.maxX + i) - fromX) * inverseX;
+				const Pack ty1 = (Pack::Load(boxes.minY + i) - fromY) * inverseY;
+				const Pack ty2 = (Pack::Load(boxes.maxY + i) - fromY) * inverseY;
+				const Pack tNear = Max(Min(tx1, tx2), Min(ty1, ty2));
+				const Pack tFar = Min(Max(tx1, tx2), Max(ty1, ty2));
+				if (((tNear > zero) & (tNear <= tFar) & (tFar < one)).Any())
+				{
+					isHit = true;
+					return i + Pack::Width;
+				}
+			}
+			return i;
+		}
+
+		template<typename Pack>
+		size_t SinCos(const float* pAngles, size_t count, float* pSines, float* pCosines)
+		{
+			size_t i = 0;
+			for (; i + Pack::Width <= count; i += Pack::Width)
+			{
+				const Pack angle = Pack::Load(pAngles + i);
+				FastSin(angle).Store(pSines + i);
+				FastCos(angle).Store(pCosines + i);
+			}
+			return i;
+		}
+
+		template<typename Pack>
+		size_t Atan2(const float* pY, const float* pX, size_t count, float* pResults)
+		{
+			size_t i = 0;
+			for (; i + Pack::Width <= count; i += Pack::Width)
+				FastAtan2(Pack::Load(pY + i), Pack::Load(pX + i)).Store(pResults + i);
+			return i;
+		}
+
+		//x * dirX + y * dirY (+ orig for points) of interleaved points, pMatrix is dirX, dirY, orig like Matrix2x3.
+		//Vectors skip the translation instead of adding 0, which would turn -0 into 0.
+		template<typename Pack>
+		size_t Transform(const float* pMatrix, const float* pPoints, size_t count, bool isPoint, float* pResults)
+		{
+			const Pack dirXx(pMatrix[0]), dirXy(pMatrix[1]), dirYx(pMatrix[2]), dirYy(pMatrix[3]);
+			const Pack origX(pMatrix[4]), origY(pMatrix[5]);
+			size_t i = 0;
+			for (; i + Pack::Width <= count; i += Pack::Width)
+			{
+				Pack x, y;
+				Pack::LoadInterleaved(pPoints + 2 * i, x, y);
+				Pack resultX = x * dirXx + y * dirYx;
+				Pack resultY = x * dirXy + y * dirYy;
+				if (isPoint)
+				{
+					resultX = resultX + origX;
+					resultY = resultY + origY;
+				}
+				Pack::StoreInterleaved(pResults + 2 * i, resultX, resultY);
+			}
+			return i;
+		}
+
+		//Block sizes of MatrixMultiply: a column block of B (BlockInner x BlockColumns) stays in L2,
+		//the packed rows of A of one tile (BlockInner x 2 packs) stay in L1 while the tile walks over the columns
+		constexpr int MatrixBlockInner{ 256 };
+		constexpr int MatrixBlockColumns{ 128 };
+
+		//C tile of RowPacks packs x Columns columns += A * B over depth values of k, the sums stay in registers.
+		//pA is the packed A tile, pB the first k of the first column
+		template<typename Pack, int RowPacks, int Columns>
+		inline void MultiplyTile(const float* pA, const float* pB, int strideB, float* pC, int strideC, int depth, bool isFirst)
+		{
+			const int width = static_cast<int>(Pack::Width);
+			Pack sums[RowPacks][Columns];
+			for (int c = 0; c < Columns; ++c)
+			{
+				for (int p = 0; p < RowPacks; ++p)
+					sums[p][c] = isFirst ? Pack(0.f) : Pack::Load(pC + c * strideC + p * width);
+			}
+			for (int k = 0; k < depth; ++k)
+			{
+				Pack a[RowPacks];
+				for (int p = 0; p < RowPacks; ++p)
+					a[p] = Pack::Load(pA + (k * RowPacks + p) * width);
+				for (int c = 0; c < Columns; ++c)
+				{
+					const Pack b(pB[c * strideB + k]);
+					for (int p = 0; p < RowPacks; ++p)
+						sums[p][c] = sums[p][c] + a[p] * b;
+				}
+			}
+			for (int c = 0; c < Columns; ++c)
+			{
+				for (int p = 0; p < RowPacks; ++p)
+					sums[p][c].Store(pC + c * strideC + p * width);
+			}
+		}
+
+		//Copies the tile rows of A for every k of the block next to each other, the columns of A are too far apart
+		//for the cache (a power of 2 stride puts them all in the same cache set)
+		template<typename Pack, int RowPacks>
+		inline void MultiplyRowTile(const float* pA, int strideA, const float* pB, int strideB, float* pC, int strideC,
+			int firstColumn, int endColumn, int firstK, int endK, float* pPackedA)
+		{
+			const int tileRows = RowPacks * static_cast<int>(Pack::Width);
+			const int depth = endK - firstK;
+			for (int k = 0; k < depth; ++k)
+			{
+				const float* pColumnA = pA + static_cast<size_t>(firstK + k) * strideA;
+				for (int r = 0; r < tileRows; ++r)
+					pPackedA[k * tileRows + r] = pColumnA[r];
+			}
+
+			const bool isFirst = firstK == 0;
+			int c = firstColumn;
+			for (; c + 4 <= endColumn; c += 4)
+				MultiplyTile<Pack, RowPacks, 4>(pPackedA, pB + c * strideB + firstK, strideB, pC + c * strideC, strideC, depth, isFirst);
+			for (; c < endColumn; ++c)
+				MultiplyTile<Pack, RowPacks, 1>(pPackedA, pB + c * strideB + firstK, strideB, pC + c * strideC, strideC, depth, isFirst);
+		}
+
+		//Column major C = A * B (strides are the distance between two columns), blocked for the caches. Every C element
+		//still sums its products with k ascending, a block only continues the sum where the previous one stored it
+		template<typename Pack>
+		int MatrixMultiply(const float* pA, int strideA, const float* pB, int strideB, float* pC, int strideC, int rows, int inner, int columns)
+		{
+			const int width = static_cast<int>(Pack::Width);
+			const int packedRows = rows - rows % width;
+			float packedA[MatrixBlockInner * 2 * Pack::Width]; //no std::vector here, see ESimdKernelsAVX2.cpp
+			for (int firstColumn = 0; firstColumn < columns; firstColumn += MatrixBlockColumns)
+			{
+				const int endColumn = columns - firstColumn < MatrixBlockColumns ? columns : firstColumn + MatrixBlockColumns;
+				for (int firstK = 0; firstK < inner; firstK += MatrixBlockInner)
+				{
+					const int endK = inner - firstK < MatrixBlockInner ? inner : firstK + MatrixBlockInner;
+					int r = 0;
+					for (; r + 2 * width <= packedRows; r += 2 * width)
+						MultiplyRowTile<Pack, 2>(pA + r, strideA, pB, strideB, pC + r, strideC, firstColumn, endColumn, firstK, endK, packedA);
+					for (; r < packedRows; r += width)
+						MultiplyRowTile<Pack, 1>(pA + r, strideA, pB, strideB, pC + r, strideC, firstColumn, endColumn, firstK, endK, packedA);
+				}
+			}
+			return packedRows;
+		}
+
+		//Dot product in DotLanes interleaved sums, reduced in a fixed order, so every level rounds the same way.
+		//Templated on the pack only so every translation unit gets its own copy (float for the scalar level).
+		constexpr size_t DotLanes{ 8 };
+		template<typename Pack>
+		inline float ReduceDotLanes(const float* pLanes)
+		{
+			return ((pLanes[0] + pLanes[4]) + (pLanes[2] + pLanes[6])) + ((pLanes[1] + pLanes[5]) + (pLanes[3] + pLanes[7]));
+		}
+
+		template<typename Pack>
+		size_t Dot(const float* pA, const float* pB, size_t count, float& dot)
+		{
+			constexpr size_t packs{ DotLanes / Pack::Width };
+			Pack sums[packs];
+			for (size_t p = 0; p < packs; ++p)
+				sums[p] = Pack(0.f);
+
+			size_t i = 0;
+			for (; i + DotLanes <= count; i += DotLanes)
+			{
+				for (size_t p = 0; p < packs; ++p)
+					sums[p] = sums[p] + Pack::Load(pA + i + p * Pack::Width) * Pack::Load(pB + i + p * Pack::Width);
+			}
+
+			float lanes[DotLanes];
+			for (size_t p = 0; p < packs; ++p)
+				sums[p].Store(lanes + p * Pack::Width);
+			dot = ReduceDotLanes<Pack>(lanes);
+			return i;
+		}
+
+		template<typename Pack>
+		SimdBulkKernels GetKernels()
+		{
+			SimdBulkKernels kernels{};
+			kernels.pDistancesSquared = &DistancesSquared<Pack>;
+			kernels.pPointInTriangles = &PointInTriangles<Pack>;
+			kernels.pFindPointInTriangles = &FindPointInTriangles<Pack>;
+			kernels.pIsPointInTriangles = &IsPointInTriangles<Pack>;
+			kernels.pSegmentCircles = &SegmentCircles<Pack>;
+			kernels.pSegmentAnyCircle = &SegmentAnyCircle<Pack>;
+			kernels.pSegmentAnyBox = &SegmentAnyBox<Pack>;
+			kernels.pSinCos = &SinCos<Pack>;
+			kernels.pAtan2 = &Atan2<Pack>;
+			kernels.pMatrixMultiply = &MatrixMultiply<Pack>;
+			kernels.pDot = &Dot<Pack>;
+			kernels.pTransform = &Transform<Pack>;
+			return kernels;
+		}
+	}
+
+	/*! AVX2 kernels, false when the AVX2 translation unit was built without AVX2 */
+	bool GetAvx2BulkKernels(SimdBulkKernels& kernels);
+}
+#endif
@@ -0,0 +1,22 @@
+/*=============================================================================*/
+// Copyright 2021-2022 Elite Engine
+/*=============================================================================*/
+// ESimdKernelsAVX2.cpp: The AVX2 instantiation of the batch kernels
+// Built with /arch:AVX2, so stdafx.h is a plain include here (the precompiled header is built without it).
+// Only use templates and the Floatx8 functions in this file: an inline function that other files use too
+// can end up as the AVX2 copy for the whole program.
+/*=============================================================================*/
+#include "stdafx.h"
+#include "ESimdDispatch.h"
+#include "ESimdKernels.h"
+
+bool Elite::GetAvx2BulkKernels(SimdBulkKernels& kernels)
+{
+#ifdef ELITE_SIMD_AVX2
+	kernels = SimdKernels::GetKernels<Floatx8>();
+	return true;
+#else
+	(void)kernels;
+	return false;
+#endif
+}
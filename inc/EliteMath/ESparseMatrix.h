@@ -0,0 +1,219 @@
+/*=============================================================================*/
+// Copyright 2021-2022 Elite Engine
+/*=============================================================================*/
+// ESparseMatrix.h: Compressed sparse row matrix, for graphs where FMatrix would be mostly zeros
+/*=============================================================================*/
+#ifndef ELITE_MATH_SPARSE_MATRIX
+#define	ELITE_MATH_SPARSE_MATRIX
+
+namespace Elite
+{
+	struct SparseEntry
+	{
+		int row;
+		int column;
+		float value;
+	};
+
+	//Compressed sparse row (CSR) matrix: the entries of a row are next to each other, sorted on column.
+	//As an adjacency matrix, row i holds the edges leaving node i, so walking a row only touches real edges.
+	//The structure is built once, only the values can change after that. Transposed() gives the
+	//compressed sparse column (CSC) layout of the same matrix.
+	class SparseMatrix final
+	{
+	public:
+		SparseMatrix() = default;
+		/*! Entries outside the matrix are skipped, duplicates are summed. With addTransposed every (row, column, value)
+			also adds (column, row, value), which turns a list of undirected edges into a symmetric adjacency matrix */
+		SparseMatrix(int rows, int columns, const std::vector<SparseEntry>& entries, bool addTransposed = false)
+		{
+			SetEntries(rows, columns, entries, addTransposed);
+		}
+		/*! Keeps the elements with |value| > epsilon */
+		explicit SparseMatrix(const FMatrix& dense, float epsilon = 0.f)
+		{
+			std::vector<SparseEntry> entries{};
+			const float* pData = dense.GetData();
+			for (int c = 0; c < dense.GetNrOfColumns(); ++c)
+			{
+				for (int r = 0; r < dense.GetNrOfRows(); ++r)
+				{
+					const float value = pData[c * dense.GetNrOfRows() + r];
+					if (fabsf(value) > epsilon)
+						entries.push_back({ r, c, value });
+				}
+			}
+			SetEntries(dense.GetNrOfRows(), dense.GetNrOfColumns(), entries);
+		}
+
+		void SetEntries(int rows, int columns, const std::vector<SparseEntry>& entries, bool addTransposed = false)
+		{
+			m_Rows = max(rows, 0);
+			m_Columns = max(columns, 0);
+
+			std::vector<SparseEntry> sorted{};
+			sorted.reserve(addTransposed ? entries.size() * 2 : entries.size());
+			for (const SparseEntry& entry : entries)
+			{
+				if (IsValidIndex(entry.row, entry.column))
+					sorted.push_back(entry);
+				if (addTransposed && entry.row != entry.column && IsValidIndex(entry.column, entry.row))
+					sorted.push_back({ entry.column, entry.row, entry.value });
+			}
+			std::sort(sorted.begin(), sorted.end(), [](const SparseEntry& a, const SparseEntry& b)
+				{ return a.row != b.row ? a.row < b.row : a.column < b.column; });
+
+			m_RowStarts.assign(m_Rows + 1, 0);
+			m_ColumnIndices.clear();
+			m_Values.clear();
+			m_ColumnIndices.reserve(sorted.size());
+			m_Values.reserve(sorted.size());
+			for (size_t i = 0; i < sorted.size(); ++i)
+			{
+				const SparseEntry& entry = sorted[i];
+				if (i > 0 && entry.row == sorted[i - 1].row && entry.column == sorted[i - 1].column)
+				{
+					m_Values.back() += entry.value;
+					continue;
+				}
+				m_ColumnIndices.push_back(entry.column);
+				m_Values.push_back(entry.value);
+				++m_RowStarts[entry.row + 1];
+			}
+			for (int r = 0; r < m_Rows; ++r)
+				m_RowStarts[r + 1] += m_RowStarts[r];
+		}
+
+		int GetNrOfRows() const { return m_Rows; }
+		int GetNrOfColumns() const { return m_Columns; }
+		int GetNrOfEntries() const { return static_cast<int>(m_Values.size()); }
+
+		/*! The entries of a row are [GetRowStart(row), GetRowEnd(row)) */
+		int GetRowStart(int row) const { return m_RowStarts[row]; }
+		int GetRowEnd(int row) const { return m_RowStarts[row + 1]; }
+		int GetRowSize(int row) const { return m_RowStarts[row + 1] - m_RowStarts[row]; }
+		int GetColumn(int entry) const { return m_ColumnIndices[entry]; }
+		float GetValue(int entry) const { return m_Values[entry]; }
+		/*! Only the values, the structure can't change */
+		void SetValue(int entry, float value) { m_Values[entry] = value; }
+
+		/*! operation(column, value) for every entry of the row, for a graph: every edge leaving node row */
+		template<typename Operation>
+		void ForEachInRow(int row, Operation operation) const
+		{
+			for (int i = m_RowStarts[row]; i < m_RowStarts[row + 1]; ++i)
+				operation(m_ColumnIndices[i], m_Values[i]);
+		}
+
+		/*! Entry index of (row, column), -1 when it isn't stored */
+		int FindEntry(int row, int column) const
+		{
+			if (!IsValidIndex(row, column))
+				return -1;
+			const auto begin = m_ColumnIndices.begin() + m_RowStarts[row];
+			const auto end = m_ColumnIndices.begin() + m_RowStarts[row + 1];
+			const auto it = std::lower_bound(begin, end, column);
+			return it != end && *it == column ? static_cast<int>(it - m_ColumnIndices.begin()) : -1;
+		}
+		float Get(int row, int column) const
+		{
+			const int entry = FindEntry(row, column);
+			return entry == -1 ? 0.f : m_Values[entry];
+		}
+
+		/*! y = this * x, x has GetNrOfColumns() values and y GetNrOfRows() */
+		void Multiply(const float* pX, float* pY) const
+		{
+			for (int r = 0; r < m_Rows; ++r)
+			{
+				float sum = 0.f;
+				for (int i = m_RowStarts[r]; i < m_RowStarts[r + 1]; ++i)
+					sum += m_Values[i] * pX[m_ColumnIndices[i]];
+				pY[r] = sum;
+			}
+		}
+		/*! y = transpose(this) * x, x has GetNrOfRows() values and y GetNrOfColumns() */
+		void MultiplyTransposed(const float* pX, float* pY) const
+		{
+			std::fill(pY, pY + m_Columns, 0.f);
+			for (int r = 0; r < m_Rows; ++r)
+			{
+				const float x = pX[r];
+				for (int i = m_RowStarts[r]; i < m_RowStarts[r + 1]; ++i)
+					pY[m_ColumnIndices[i]] += m_Values[i] * x;
+			}
+		}
+		/*! result = this * dense, on the columns both have */
+		void MatrixMultiply(const FMatrix& dense, FMatrix& result) const
+		{
+			if (dense.GetNrOfRows() != m_Columns || result.GetNrOfRows() != m_Rows)
+			{
+				printf("SparseMatrix: can't multiply %d x %d with %d x %d into %d x %d\n", m_Rows, m_Columns,
+					dense.GetNrOfRows(), dense.GetNrOfColumns(), result.GetNrOfRows(), result.GetNrOfColumns());
+				return;
+			}
+			const int columns = min(dense.GetNrOfColumns(), result.GetNrOfColumns());
+			for (int c = 0; c < columns; ++c)
+				Multiply(dense.GetData() + c * m_Columns, result.GetData() + c * m_Rows);
+		}
+
+		SparseMatrix Transposed() const
+		{
+			SparseMatrix transposed{};
+			transposed.m_Rows = m_Columns;
+			transposed.m_Columns = m_Rows;
+			transposed.m_RowStarts.assign(m_Columns + 1, 0);
+			transposed.m_ColumnIndices.resize(m_ColumnIndices.size());
+			transposed.m_Values.resize(m_Values.size());
+
+			//Counting sort on column, walking the rows in order keeps every new row sorted
+			for (const int column : m_ColumnIndices)
+				++transposed.m_RowStarts[column + 1];
+			for (int c = 0; c < m_Columns; ++c)
+				transposed.m_RowStarts[c + 1] += transposed.m_RowStarts[c];
+			std::vector<int> next(transposed.m_RowStarts.begin(), transposed.m_RowStarts.end() - 1);
+			for (int r = 0; r < m_Rows; ++r)
+			{
+				for (int i = m_RowStarts[r]; i < m_RowStarts[r + 1]; ++i)
+				{
+					const int destination = next[m_ColumnIndices[i]]++;
+					transposed.m_ColumnIndices[destination] = r;
+					transposed.m_Values[destination] = m_Values[i];
+				}
+			}
+			return transposed;
+		}
+
+		FMatrix ToDense() const
+		{
+			FMatrix dense{ m_Rows, m_Columns };
+			dense.SetAll(0.f);
+			float* pData = dense.GetData();
+			for (int r = 0; r < m_Rows; ++r)
+			{
+				for (int i = m_RowStarts[r]; i < m_RowStarts[r + 1]; ++i)
+					pData[m_ColumnIndices[i] * m_Rows + r] = m_Values[i];
+			}
+			return dense;
+		}
+
+		/*! Memory used by the three arrays */
+		size_t GetMemorySize() const
+		{
+			return m_RowStarts.size() * sizeof(int) + m_ColumnIndices.size() * sizeof(int) + m_Values.size() * sizeof(float);
+		}
+
+	private:
+		bool IsValidIndex(int r, int c) const
+		{
+			return r >= 0 && r < m_Rows && c >= 0 && c < m_Columns;
+		}
+
+		int m_Rows{};
+		int m_Columns{};
+		std::vector<int> m_RowStarts{ 0 }; //m_Rows + 1 offsets in the two arrays below
+		std::vector<int> m_ColumnIndices{};
+		std::vector<float> m_Values{};
+	};
+}
+#endif
@@ -216,20 +216,32 @@ namespace Elite
 	/*  Creates a normalized vector from an angle in radians.  */
 	inline Vector2 OrientationToVector(float orientation)
 	{
+#ifdef ELITE_FAST_TRIG
+		return Vector2(FastCos(orientation), FastSin(orientation));
+#else
 		return Vector2(cos(orientation), sin(orientation));
+#endif
 	}
 
 	/*Calculates the orientation angle from a vector*/
 	inline float VectorToOrientation(const Vector2& vector)
 	{
+#ifdef ELITE_FAST_TRIG
+		return FastAtan2(vector.y, vector.x);
+#else
 		return atan2f(vector.y, vector.x);
+#endif
 	}
 
 	/*! Get Angle Between 2 vectors*/
 	inline float AngleBetween(const Elite::Vector2& v1, const Elite::Vector2& v2) {
 		float x = v1.Dot(v2);
 		float y = v1.Cross(v2);
+#ifdef ELITE_FAST_TRIG
+		return FastAtan2(y, x);
+#else
 		return atan2(y, x);
+#endif
 	}
 
 #pragma endregion //ExtraFunctions
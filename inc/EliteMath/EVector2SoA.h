@@ -0,0 +1,334 @@
+/*=============================================================================*/
+// Copyright 2021-2022 Elite Engine
+/*=============================================================================*/
+// EVector2SoA.h: Structure of arrays Vector2 types, 4 (SSE) or 8 (AVX2) vectors at once
+/*=============================================================================*/
+#ifndef ELITE_MATH_VECTOR2_SOA
+#define	ELITE_MATH_VECTOR2_SOA
+
+#include <vector>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define ELITE_SIMD_SSE
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#define ELITE_SIMD_AVX2
+#include <immintrin.h>
+#endif
+
+namespace Elite
+{
+	static_assert(sizeof(Vector2) == 2 * sizeof(float), "The SoA gather/scatter expect Vector2 to be 2 packed floats");
+
+	//=== Float Packs ===
+	//Every pack has the same interface, Vector2Pack and the functions below work on all of them.
+	//Comparisons give a mask pack, Select picks per lane with it.
+#pragma region Floatx4
+	struct Maskx4
+	{
+#ifdef ELITE_SIMD_SSE
+		__m128 v;
+		int GetBits() const { return _mm_movemask_ps(v); }
+#else
+		bool v[4];
+		int GetBits() const { return v[0] | (v[1] << 1) | (v[2] << 2) | (v[3] << 3); }
+#endif
+		bool Any() const { return GetBits() != 0; }
+		bool All() const { return GetBits() == 0xF; }
+	};
+
+	struct Floatx4
+	{
+		static constexpr size_t Width = 4;
+		using Mask = Maskx4;
+
+#ifdef ELITE_SIMD_SSE
+		__m128 v;
+
+		Floatx4() = default;
+		Floatx4(__m128 value) : v(value) {}
+		explicit Floatx4(float f) : v(_mm_set1_ps(f)) {}
+
+		static Floatx4 Load(const float* p) { return _mm_loadu_ps(p); }
+		void Store(float* p) const { _mm_storeu_ps(p, v); }
+
+		//Points as x0 y0 x1 y1 ... to x and y packs and back
+		static void LoadInterleaved(const float* p, Floatx4& x, Floatx4& y)
+		{
+			const __m128 first = _mm_loadu_ps(p);
+			const __m128 second = _mm_loadu_ps(p + 4);
+			x = _mm_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0));
+			y = _mm_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1));
+		}
+		static void StoreInterleaved(float* p, const Floatx4& x, const Floatx4& y)
+		{
+			_mm_storeu_ps(p, _mm_unpacklo_ps(x.v, y.v));
+			_mm_storeu_ps(p + 4, _mm_unpackhi_ps(x.v, y.v));
+		}
+#else
+		float v[4];
+
+		Floatx4() = default;
+		explicit Floatx4(float f) : v{ f, f, f, f } {}
+
+		static Floatx4 Load(const float* p) { Floatx4 r; for (int i = 0; i < 4; ++i) r.v[i] = p[i]; return r; }
+		void Store(float* p) const { for (int i = 0; i < 4; ++i) p[i] = v[i]; }
+
+		static void LoadInterleaved(const float* p, Floatx4& x, Floatx4& y)
+		{
+			for (int i = 0; i < 4; ++i) { x.v[i] = p[2 * i]; y.v[i] = p[2 * i + 1]; }
+		}
+		static void StoreInterleaved(float* p, const Floatx4& x, const Floatx4& y)
+		{
+			for (int i = 0; i < 4; ++i) { p[2 * i] = x.v[i]; p[2 * i + 1] = y.v[i]; }
+		}
+#endif
+	};
+
+#ifdef ELITE_SIMD_SSE
+	inline Floatx4 operator+(const Floatx4& a, const Floatx4& b) { return _mm_add_ps(a.v, b.v); }
+	inline Floatx4 operator-(const Floatx4& a, const Floatx4& b) { return _mm_sub_ps(a.v, b.v); }
+	inline Floatx4 operator*(const Floatx4& a, const Floatx4& b) { return _mm_mul_ps(a.v, b.v); }
+	inline Floatx4 operator/(const Floatx4& a, const Floatx4& b) { return _mm_div_ps(a.v, b.v); }
+	inline Floatx4 Min(const Floatx4& a, const Floatx4& b) { return _mm_min_ps(a.v, b.v); }
+	inline Floatx4 Max(const Floatx4& a, const Floatx4& b) { return _mm_max_ps(a.v, b.v); }
+	inline Floatx4 Sqrt(const Floatx4& a) { return _mm_sqrt_ps(a.v); }
+	/*! Fast inverse square root, hardware estimate with one Newton-Raphson step (about 22 bits) */
+	inline Floatx4 InvSqrt(const Floatx4& a)
+	{
+		const __m128 estimate = _mm_rsqrt_ps(a.v);
+		const __m128 halfA = _mm_mul_ps(_mm_set1_ps(0.5f), a.v);
+		return _mm_mul_ps(estimate, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(halfA, _mm_mul_ps(estimate, estimate))));
+	}
+	inline Maskx4 operator<(const Floatx4& a, const Floatx4& b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+	inline Maskx4 operator<=(const Floatx4& a, const Floatx4& b) { return { _mm_cmple_ps(a.v, b.v) }; }
+	inline Maskx4 operator>(const Floatx4& a, const Floatx4& b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+	inline Maskx4 operator>=(const Floatx4& a, const Floatx4& b) { return { _mm_cmpge_ps(a.v, b.v) }; }
+	inline Maskx4 operator&(const Maskx4& a, const Maskx4& b) { return { _mm_and_ps(a.v, b.v) }; }
+	inline Maskx4 operator|(const Maskx4& a, const Maskx4& b) { return { _mm_or_ps(a.v, b.v) }; }
+	/*! Per lane mask ? a : b */
+	inline Floatx4 Select(const Maskx4& mask, const Floatx4& a, const Floatx4& b)
+	{
+		return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v));
+	}
+#else
+	#define ELITE_FLOATX4_OP(expression) Floatx4 r; for (int i = 0; i < 4; ++i) r.v[i] = expression; return r;
+	#define ELITE_MASKX4_OP(expression) Maskx4 r; for (int i = 0; i < 4; ++i) r.v[i] = expression; return r;
+	inline Floatx4 operator+(const Floatx4& a, const Floatx4& b) { ELITE_FLOATX4_OP(a.v[i] + b.v[i]) }
+	inline Floatx4 operator-(const Floatx4& a, const Floatx4& b) { ELITE_FLOATX4_OP(a.v[i] - b.v[i]) }
+	inline Floatx4 operator*(const Floatx4& a, const Floatx4& b) { ELITE_FLOATX4_OP(a.v[i] * b.v[i]) }
+	inline Floatx4 operator/(const Floatx4& a, const Floatx4& b) { ELITE_FLOATX4_OP(a.v[i] / b.v[i]) }
+	inline Floatx4 Min(const Floatx4& a, const Floatx4& b) { ELITE_FLOATX4_OP(a.v[i] < b.v[i] ? a.v[i] : b.v[i]) }
+	inline Floatx4 Max(const Floatx4& a, const Floatx4& b) { ELITE_FLOATX4_OP(a.v[i] > b.v[i] ? a.v[i] : b.v[i]) }
+	inline Floatx4 Sqrt(const Floatx4& a) { ELITE_FLOATX4_OP(sqrtf(a.v[i])) }
+	inline Floatx4 InvSqrt(const Floatx4& a) { ELITE_FLOATX4_OP(1.f / sqrtf(a.v[i])) }
+	inline Maskx4 operator<(const Floatx4& a, const Floatx4& b) { ELITE_MASKX4_OP(a.v[i] < b.v[i]) }
+	inline Maskx4 operator<=(const Floatx4& a, const Floatx4& b) { ELITE_MASKX4_OP(a.v[i] <= b.v[i]) }
+	inline Maskx4 operator>(const Floatx4& a, const Floatx4& b) { ELITE_MASKX4_OP(a.v[i] > b.v[i]) }
+	inline Maskx4 operator>=(const Floatx4& a, const Floatx4& b) { ELITE_MASKX4_OP(a.v[i] >= b.v[i]) }
+	inline Maskx4 operator&(const Maskx4& a, const Maskx4& b) { ELITE_MASKX4_OP(a.v[i] && b.v[i]) }
+	inline Maskx4 operator|(const Maskx4& a, const Maskx4& b) { ELITE_MASKX4_OP(a.v[i] || b.v[i]) }
+	inline Floatx4 Select(const Maskx4& mask, const Floatx4& a, const Floatx4& b) { ELITE_FLOATX4_OP(mask.v[i] ? a.v[i] : b.v[i]) }
+	#undef ELITE_FLOATX4_OP
+	#undef ELITE_MASKX4_OP
+#endif
+#pragma endregion //Floatx4
+
+#ifdef ELITE_SIMD_AVX2
+#pragma region Floatx8
+	struct Maskx8
+	{
+		__m256 v;
+		int GetBits() const { return _mm256_movemask_ps(v); }
+		bool Any() const { return GetBits() != 0; }
+		bool All() const { return GetBits() == 0xFF; }
+	};
+
+	struct Floatx8
+	{
+		static constexpr size_t Width = 8;
+		using Mask = Maskx8;
+
+		__m256 v;
+
+		Floatx8() = default;
+		Floatx8(__m256 value) : v(value) {}
+		explicit Floatx8(float f) : v(_mm256_set1_ps(f)) {}
+
+		static Floatx8 Load(const float* p) { return _mm256_loadu_ps(p); }
+		void Store(float* p) const { _mm256_storeu_ps(p, v); }
+
+		static void LoadInterleaved(const float* p, Floatx8& x, Floatx8& y)
+		{
+			//The shuffles work per 128 bit half, so first put points 0-1 with 4-5 and 2-3 with 6-7
+			const __m256 first = _mm256_loadu_ps(p);
+			const __m256 second = _mm256_loadu_ps(p + 8);
+			const __m256 low = _mm256_permute2f128_ps(first, second, 0x20);
+			const __m256 high = _mm256_permute2f128_ps(first, second, 0x31);
+			x = _mm256_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+			y = _mm256_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+		}
+		static void StoreInterleaved(float* p, const Floatx8& x, const Floatx8& y)
+		{
+			const __m256 low = _mm256_unpacklo_ps(x.v, y.v);
+			const __m256 high = _mm256_unpackhi_ps(x.v, y.v);
+			_mm256_storeu_ps(p, _mm256_permute2f128_ps(low, high, 0x20));
+			_mm256_storeu_ps(p + 8, _mm256_permute2f128_ps(low, high, 0x31));
+		}
+	};
+
+	inline Floatx8 operator+(const Floatx8& a, const Floatx8& b) { return _mm256_add_ps(a.v, b.v); }
+	inline Floatx8 operator-(const Floatx8& a, const Floatx8& b) { return _mm256_sub_ps(a.v, b.v); }
+	inline Floatx8 operator*(const Floatx8& a, const Floatx8& b) { return _mm256_mul_ps(a.v, b.v); }
+	inline Floatx8 operator/(const Floatx8& a, const Floatx8& b) { return _mm256_div_ps(a.v, b.v); }
+	inline Floatx8 Min(const Floatx8& a, const Floatx8& b) { return _mm256_min_ps(a.v, b.v); }
+	inline Floatx8 Max(const Floatx8& a, const Floatx8& b) { return _mm256_max_ps(a.v, b.v); }
+	inline Floatx8 Sqrt(const Floatx8& a) { return _mm256_sqrt_ps(a.v); }
+	/*! Fast inverse square root, hardware estimate with one Newton-Raphson step (about 22 bits) */
+	inline Floatx8 InvSqrt(const Floatx8& a)
+	{
+		const __m256 estimate = _mm256_rsqrt_ps(a.v);
+		const __m256 halfA = _mm256_mul_ps(_mm256_set1_ps(0.5f), a.v);
+		return _mm256_mul_ps(estimate, _mm256_sub_ps(_mm256_set1_ps(1.5f), _mm256_mul_ps(halfA, _mm256_mul_ps(estimate, estimate))));
+	}
+	inline Maskx8 operator<(const Floatx8& a, const Floatx8& b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+	inline Maskx8 operator<=(const Floatx8& a, const Floatx8& b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+	inline Maskx8 operator>(const Floatx8& a, const Floatx8& b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+	inline Maskx8 operator>=(const Floatx8& a, const Floatx8& b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ) }; }
+	inline Maskx8 operator&(const Maskx8& a, const Maskx8& b) { return { _mm256_and_ps(a.v, b.v) }; }
+	inline Maskx8 operator|(const Maskx8& a, const Maskx8& b) { return { _mm256_or_ps(a.v, b.v) }; }
+	/*! Per lane mask ? a : b */
+	inline Floatx8 Select(const Maskx8& mask, const Floatx8& a, const Floatx8& b) { return _mm256_blendv_ps(b.v, a.v, mask.v); }
+#pragma endregion //Floatx8
+#endif
+
+	//=== Vector2 Packs ===
+#pragma region Vector2Pack
+	template<typename Pack>
+	struct Vector2Pack
+	{
+		static constexpr size_t Width = Pack::Width;
+
+		//=== Datamembers ===
+		Pack x;
+		Pack y;
+
+		//=== Constructors ===
+		Vector2Pack() = default;
+		Vector2Pack(const Pack& _x, const Pack& _y) :x(_x), y(_y) {}
+		explicit Vector2Pack(const Vector2& v) :x(v.x), y(v.y) {} /*! Same vector in every lane */
+
+		//=== Arithmetic Operators ===
+		inline Vector2Pack operator+(const Vector2Pack& v) const { return { x + v.x, y + v.y }; }
+		inline Vector2Pack operator-(const Vector2Pack& v) const { return { x - v.x, y - v.y }; }
+		inline Vector2Pack operator*(const Pack& scale) const { return { x * scale, y * scale }; }
+		inline Vector2Pack operator*(float scale) const { return *this * Pack(scale); }
+		inline Vector2Pack operator/(const Pack& scale) const { return { x / scale, y / scale }; }
+	};
+
+	using Vector2x4 = Vector2Pack<Floatx4>;
+#ifdef ELITE_SIMD_AVX2
+	using Vector2x8 = Vector2Pack<Floatx8>;
+#endif
+
+	template<typename Pack>
+	inline Pack Dot(const Vector2Pack<Pack>& v1, const Vector2Pack<Pack>& v2)
+	{ return v1.x * v2.x + v1.y * v2.y; }
+
+	template<typename Pack>
+	inline Pack Cross(const Vector2Pack<Pack>& v1, const Vector2Pack<Pack>& v2)
+	{ return v1.x * v2.y - v1.y * v2.x; }
+
+	template<typename Pack>
+	inline Pack MagnitudeSquared(const Vector2Pack<Pack>& v)
+	{ return v.x * v.x + v.y * v.y; }
+
+	template<typename Pack>
+	inline Pack Magnitude(const Vector2Pack<Pack>& v)
+	{ return Sqrt(MagnitudeSquared(v)); }
+
+	template<typename Pack>
+	inline Pack DistanceSquared(const Vector2Pack<Pack>& v1, const Vector2Pack<Pack>& v2)
+	{ return MagnitudeSquared(v2 - v1); }
+
+	template<typename Pack>
+	inline Pack Distance(const Vector2Pack<Pack>& v1, const Vector2Pack<Pack>& v2)
+	{ return Sqrt(DistanceSquared(v1, v2)); }
+
+	/*! Per lane mask ? a : b */
+	template<typename Pack>
+	inline Vector2Pack<Pack> Select(const typename Pack::Mask& mask, const Vector2Pack<Pack>& a, const Vector2Pack<Pack>& b)
+	{ return { Select(mask, a.x, b.x), Select(mask, a.y, b.y) }; }
+
+	/*! Same as Vector2::Normalize per lane: (nearly) zero vectors become zero, returns the magnitudes */
+	template<typename Pack>
+	inline Pack Normalize(Vector2Pack<Pack>& v)
+	{
+		const Pack magnitude{ Magnitude(v) };
+		const typename Pack::Mask isZero{ magnitude <= Pack(FLT_EPSILON) };
+		const Pack inverseMagnitude{ Select(isZero, Pack(0.f), Pack(1.f) / magnitude) };
+		v = v * inverseMagnitude;
+		return Select(isZero, Pack(0.f), magnitude);
+	}
+
+	/*! Normalize with the fast InvSqrt, zero vectors stay zero */
+	template<typename Pack>
+	inline void NormalizeFast(Vector2Pack<Pack>& v)
+	{
+		const Pack magnitudeSquared{ MagnitudeSquared(v) };
+		const typename Pack::Mask isZero{ magnitudeSquared <= Pack(FLT_EPSILON * FLT_EPSILON) };
+		v = v * Select(isZero, Pack(0.f), InvSqrt(magnitudeSquared));
+	}
+#pragma endregion //Vector2Pack
+
+	//=== Gather/Scatter ===
+#pragma region GatherScatter
+	/*! Loads points [first, first + Width) in the lanes, lanes past the end of the vector get the zero vector */
+	template<typename Pack>
+	inline Vector2Pack<Pack> Gather(const std::vector<Vector2>& points, size_t first)
+	{
+		Vector2Pack<Pack> result{};
+		if (first + Pack::Width <= points.size())
+		{
+			Pack::LoadInterleaved(&points[first].x, result.x, result.y);
+			return result;
+		}
+
+		float buffer[2 * Pack::Width]{};
+		for (size_t i = first; i < points.size(); ++i)
+		{
+			buffer[2 * (i - first)] = points[i].x;
+			buffer[2 * (i - first) + 1] = points[i].y;
+		}
+		Pack::LoadInterleaved(buffer, result.x, result.y);
+		return result;
+	}
+
+	/*! Stores the lanes in points [first, first + Width), lanes past the end of the vector are dropped */
+	template<typename Pack>
+	inline void Scatter(const Vector2Pack<Pack>& v, std::vector<Vector2>& points, size_t first)
+	{
+		if (first + Pack::Width <= points.size())
+		{
+			Pack::StoreInterleaved(&points[first].x, v.x, v.y);
+			return;
+		}
+
+		float buffer[2 * Pack::Width];
+		Pack::StoreInterleaved(buffer, v.x, v.y);
+		for (size_t i = first; i < points.size(); ++i)
+			points[i] = { buffer[2 * (i - first)], buffer[2 * (i - first) + 1] };
+	}
+
+	/*! Lane i of the pack, only meant for the odd single value (debugging, tails) */
+	template<typename Pack>
+	inline float GetLane(const Pack& pack, size_t lane)
+	{
+		float values[Pack::Width];
+		pack.Store(values);
+		return values[lane];
+	}
+#pragma endregion //GatherScatter
+}
+#endif
@@ -8,8 +8,14 @@
 #define	ELITE_MATH_FMATRIX
 
 #include <random>
+#include <cstring>
+#include <cstdlib>
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
 namespace Elite 
 {
+	//Column major float matrix. The data is aligned for the SIMD kernels, Get and Set only check the indices in debug builds.
 	class FMatrix
 	{
 	public:
@@ -17,36 +23,82 @@ namespace Elite
 		FMatrix(int rows, int columns): 
 			m_Rows(rows),
 			m_Columns(columns),
-			m_Data(new float[rows * columns]),
+			m_Data(AllocateData(rows * columns)),
 			m_Size(rows * columns)
 		{}
+		FMatrix(const FMatrix& other):
+			FMatrix(other.m_Rows, other.m_Columns)
+		{
+			if (m_Size > 0)
+				memcpy(m_Data, other.m_Data, m_Size * sizeof(float));
+		}
+		FMatrix(FMatrix&& other) noexcept:
+			m_Data(other.m_Data),
+			m_Rows(other.m_Rows),
+			m_Columns(other.m_Columns),
+			m_Size(other.m_Size)
+		{
+			other.m_Data = nullptr;
+			other.m_Rows = other.m_Columns = other.m_Size = 0;
+		}
 
 		virtual ~FMatrix()
 		{
-			delete[] m_Data;
+			FreeData(m_Data);
 			m_Data = nullptr;
 		}
 
+		FMatrix& operator=(const FMatrix& other)
+		{
+			if (this == &other)
+				return *this;
+
+			if (m_Size != other.m_Size)
+			{
+				FreeData(m_Data);
+				m_Data = AllocateData(other.m_Size);
+				m_Size = other.m_Size;
+			}
+			m_Rows = other.m_Rows;
+			m_Columns = other.m_Columns;
+			if (m_Size > 0)
+				memcpy(m_Data, other.m_Data, m_Size * sizeof(float));
+			return *this;
+		}
+		FMatrix& operator=(FMatrix&& other) noexcept
+		{
+			if (this == &other)
+				return *this;
+
+			FreeData(m_Data);
+			m_Data = other.m_Data;
+			m_Rows = other.m_Rows;
+			m_Columns = other.m_Columns;
+			m_Size = other.m_Size;
+			other.m_Data = nullptr;
+			other.m_Rows = other.m_Columns = other.m_Size = 0;
+			return *this;
+		}
+
 		void Resize(int nrOfRows, int nrOfColumns)
 		{
 			m_Rows = nrOfRows;
 			m_Columns = nrOfColumns;
 			m_Size = m_Rows * m_Columns;
-			delete[] m_Data; //ATTENTION: DELETES OLD DATA IN MATRIX
-			m_Data = new float[m_Size];
+			FreeData(m_Data); //ATTENTION: DELETES OLD DATA IN MATRIX
+			m_Data = AllocateData(m_Size);
 		}
 
 		void Set(int row, int column, float value)
 		{
-			int index = RcToIndex(row, column);
-			if (index > -1 && index < m_Size) 
-			{
-				m_Data[index] = value;
-			}
-			else 
+#ifdef _DEBUG
+			if (!IsValidIndex(row, column))
 			{
 				printf("Wrong index! [%d, %d]\n", row, column);
+				return;
 			}
+#endif
+			m_Data[RcToIndex(row, column)] = value;
 		}
 		void SetAll(float value)
 		{
@@ -64,46 +116,39 @@ namespace Elite
 		}
 		void Randomize(float min, float max)
 		{
+			Random& random = GetThreadRandom();
 			for (int i = 0; i < m_Size; ++i)
 			{
-				float r = min + static_cast <float> (rand()) / (static_cast <float> (RAND_MAX / (max - min)));
-				m_Data[i] = r;
+				m_Data[i] = random.NextFloat(min, max);
 			}
 		}
 
 		void Add(int row, int column, float toAdd)
 		{
-			int index = RcToIndex(row, column);
-			if (index > -1 && index < m_Size) {
-				m_Data[index] += toAdd;
-			}
-			else {
+#ifdef _DEBUG
+			if (!IsValidIndex(row, column))
+			{
 				printf("Wrong index! [%d, %d]\n", row, column);
+				return;
 			}
+#endif
+			m_Data[RcToIndex(row, column)] += toAdd;
 		}
 		void Add(const FMatrix& other)
 		{
-			int maxRows = min(GetNrOfRows(), other.GetNrOfRows());
-			int maxColumns = min(GetNrOfColumns(), other.GetNrOfColumns());
-
-			for (int c_row = 0; c_row < maxRows; ++c_row) {
-				for (int c_column = 0; c_column < maxColumns; ++c_column) {
-					float oVal = other.Get(c_row, c_column);
-					float thisVal = Get(c_row, c_column);
-					Set(c_row, c_column, thisVal + oVal);
-				}
-			}
+			ForEachOverlapping(other, [](float& value, float otherValue) { value += otherValue; });
 		}
 		
 		float Get(int row, int column) const
 		{
-			int index = RcToIndex(row, column);
-			if (index > -1 && index < m_Size) {
-				return m_Data[index];
-			}
-			else {
+#ifdef _DEBUG
+			if (!IsValidIndex(row, column))
+			{
+				printf("Wrong index! [%d, %d]\n", row, column);
 				return -1;
 			}
+#endif
+			return m_Data[RcToIndex(row, column)];
 		}
 		int GetNrOfRows() const
 		{
@@ -113,23 +158,31 @@ namespace Elite
 		{
 			return m_Columns;
 		}
-		void MatrixMultiply(const FMatrix& op2, FMatrix& result)
+		/*! Column major, element (row, column) is at column * GetNrOfRows() + row */
+		float* GetData()
 		{
-			int maxRows = min(GetNrOfRows(), result.GetNrOfRows());
-			int maxColumns = min(op2.GetNrOfColumns(), result.GetNrOfColumns());
-
-			for (int c_row = 0; c_row < maxRows; ++c_row)
+			return m_Data;
+		}
+		const float* GetData() const
+		{
+			return m_Data;
+		}
+		/*! result = this * op2, on the part of the matrices that overlaps */
+		void MatrixMultiply(const FMatrix& op2, FMatrix& result) const
+		{
+			if (&result == this || &result == &op2)
 			{
-				for (int c_column = 0; c_column < maxColumns; ++c_column)
-				{
-					float sum = 0;
-					for (int index = 0; index < GetNrOfColumns(); ++index)
-					{
-						sum += Get(c_row, index) * op2.Get(index, c_column);
-					}
-					result.Set(c_row, c_column, sum);
-				}
+				FMatrix product{ result };
+				MatrixMultiply(op2, product);
+				result = std::move(product);
+				return;
 			}
+
+			const int rows = min(GetNrOfRows(), result.GetNrOfRows());
+			const int columns = min(op2.GetNrOfColumns(), result.GetNrOfColumns());
+			const int inner = min(GetNrOfColumns(), op2.GetNrOfRows());
+			if (rows > 0 && columns > 0)
+				Simd::MatrixMultiply(m_Data, m_Rows, op2.m_Data, op2.m_Rows, result.m_Data, result.m_Rows, rows, inner, columns);
 		}
 		void ScalarMultiply(float scalar)
 		{
@@ -141,38 +194,18 @@ namespace Elite
 
 		void Copy(const FMatrix& other)
 		{
-			int maxRows = min(GetNrOfRows(), other.GetNrOfRows());
-			int maxColumns = min(GetNrOfColumns(), other.GetNrOfColumns());
-
-			for (int c_row = 0; c_row < maxRows; ++c_row) {
-				for (int c_column = 0; c_column < maxColumns; ++c_column) {
-					float oVal = other.Get(c_row, c_column);
-					Set(c_row, c_column, oVal);
-				}
-			}
+			ForEachOverlapping(other, [](float& value, float otherValue) { value = otherValue; });
 		}
 
 		void Subtract(const FMatrix& other)
 		{
-			int maxRows = min(GetNrOfRows(), other.GetNrOfRows());
-			int maxColumns = min(GetNrOfColumns(), other.GetNrOfColumns());
-
-			for (int c_row = 0; c_row < maxRows; ++c_row) 
-			{
-				for (int c_column = 0; c_column < maxColumns; ++c_column) 
-				{
-					float oVal = other.Get(c_row, c_column);
-					float thisVal = Get(c_row, c_column);
-					Set(c_row, c_column, thisVal - oVal);
-				}
-			}
+			ForEachOverlapping(other, [](float& value, float otherValue) { value -= otherValue; });
 		}
 		void Sigmoid()
 		{
 			for (int i = 0; i < m_Size; ++i)
 			{
-				float val = m_Data[i];
-				m_Data[i] = 1 / (1 + exp(-val));
+				m_Data[i] = 1 / (1 + exp(-m_Data[i]));
 			}
 		}
 
@@ -185,18 +218,18 @@ namespace Elite
 			}
 			return sum;
 		}
+		/*! Sum of the products of the overlapping elements */
 		float Dot(const FMatrix& op2) const
 		{
-			int mR = min(GetNrOfRows(), op2.GetNrOfRows());
-			int mC = min(GetNrOfColumns(), op2.GetNrOfColumns());
+			const int rows = min(GetNrOfRows(), op2.GetNrOfRows());
+			const int columns = min(GetNrOfColumns(), op2.GetNrOfColumns());
+			if (rows == m_Rows && rows == op2.m_Rows)
+				return Simd::Dot(m_Data, op2.m_Data, static_cast<size_t>(rows) * columns);
 
 			float dot = 0;
-			for (int c_row = 0; c_row < mR; ++c_row) {
-				for (int c_column = 0; c_column < mC; ++c_column) {
-					float v1 = Get(c_row, c_column);
-					float v2 = Get(c_row, c_column);
-					dot += v1 * v2;
-				}
+			for (int c = 0; c < columns; ++c)
+			{
+				dot += Simd::Dot(m_Data + c * m_Rows, op2.m_Data + c * op2.m_Rows, rows);
 			}
 			return dot;
 		}
@@ -257,10 +290,51 @@ namespace Elite
 			float* m_Data;
 			int m_Rows, m_Columns;
 			int m_Size;
+			static constexpr size_t Alignment{ 32 }; //an AVX register
+
 			int RcToIndex(int r, int c) const
 			{
 				return c * m_Rows + r;
 			}
+			bool IsValidIndex(int r, int c) const
+			{
+				return r >= 0 && r < m_Rows && c >= 0 && c < m_Columns;
+			}
+
+			static float* AllocateData(int size)
+			{
+				if (size <= 0)
+					return nullptr;
+				const size_t bytes = (size * sizeof(float) + Alignment - 1) / Alignment * Alignment;
+#ifdef _MSC_VER
+				return static_cast<float*>(_aligned_malloc(bytes, Alignment));
+#else
+				return static_cast<float*>(aligned_alloc(Alignment, bytes));
+#endif
+			}
+			static void FreeData(float* pData)
+			{
+#ifdef _MSC_VER
+				_aligned_free(pData);
+#else
+				free(pData);
+#endif
+			}
+
+			//operation(value, otherValue) on the elements both matrices have, a column at a time so the loops vectorize
+			template<typename Operation>
+			void ForEachOverlapping(const FMatrix& other, Operation operation)
+			{
+				const int rows = min(GetNrOfRows(), other.GetNrOfRows());
+				const int columns = min(GetNrOfColumns(), other.GetNrOfColumns());
+				for (int c = 0; c < columns; ++c)
+				{
+					float* pColumn = m_Data + c * m_Rows;
+					const float* pOtherColumn = other.m_Data + c * other.m_Rows;
+					for (int r = 0; r < rows; ++r)
+						operation(pColumn[r], pOtherColumn[r]);
+				}
+			}
 	};
 }
 #endif
@@ -0,0 +1,127 @@
+#include "stdafx.h"
+#include "BehaviorProfiler.h"
+
+#ifdef ELITE_BT_PROFILER
+using namespace Elite;
+
+namespace
+{
+	// Inclusive minus what the children used
+	uint64_t GetExclusiveTime(const IBehavior* pBehavior)
+	{
+		uint64_t time{ pBehavior->GetStats().inclusiveTime };
+		for (int i = 0; i < pBehavior->GetChildCount(); ++i)
+			time -= pBehavior->GetChild(i)->GetStats().inclusiveTime;
+		return time;
+	}
+	uint64_t GetExclusiveHostCalls(const IBehavior* pBehavior)
+	{
+		uint64_t hostCalls{ pBehavior->GetStats().hostCalls };
+		for (int i = 0; i < pBehavior->GetChildCount(); ++i)
+			hostCalls -= pBehavior->GetChild(i)->GetStats().hostCalls;
+		return hostCalls;
+	}
+	float ToMilliseconds(uint64_t nanoseconds) { return static_cast<float>(nanoseconds) / 1000000.f; }
+
+	void RenderNode(const IBehavior* pBehavior, uint64_t totalTime)
+	{
+		const BehaviorStats& stats{ pBehavior->GetStats() };
+		const uint64_t exclusiveTime{ GetExclusiveTime(pBehavior) };
+
+		bool isOpen{ false };
+		if (pBehavior->GetChildCount() > 0)
+		{
+			ImGui::SetNextTreeNodeOpened(true, ImGuiSetCond_Once);
+			isOpen = ImGui::TreeNode(pBehavior, "%s", pBehavior->GetName());
+		}
+		else
+		{
+			ImGui::Bullet();
+			ImGui::Text("%s", pBehavior->GetName());
+		}
+		ImGui::NextColumn();
+
+		ImGui::Text("%u", stats.ticks); ImGui::NextColumn();
+		ImGui::Text("%u / %u / %u", stats.successes, stats.failures, stats.running); ImGui::NextColumn();
+		ImGui::Text("%.3f", ToMilliseconds(stats.inclusiveTime)); ImGui::NextColumn();
+		ImGui::Text("%.3f", ToMilliseconds(exclusiveTime)); ImGui::NextColumn();
+		ImGui::Text("%.1f%%", totalTime > 0 ? 100.f * static_cast<float>(exclusiveTime) / static_cast<float>(totalTime) : 0.f); ImGui::NextColumn();
+		ImGui::Text("%llu", static_cast<unsigned long long>(stats.hostCalls)); ImGui::NextColumn();
+
+		if (isOpen)
+		{
+			for (int i = 0; i < pBehavior->GetChildCount(); ++i)
+				RenderNode(pBehavior->GetChild(i), totalTime);
+			ImGui::TreePop();
+		}
+	}
+
+	void ExportNode(std::ofstream& file, const IBehavior* pBehavior, const std::string& parentPath, int index)
+	{
+		const std::string path{ parentPath.empty() ? pBehavior->GetName()
+			: parentPath + "/" + std::to_string(index) + " " + pBehavior->GetName() };
+		const BehaviorStats& stats{ pBehavior->GetStats() };
+		file << '"' << path << "\"," << stats.ticks << ',' << stats.successes << ',' << stats.failures << ',' << stats.running << ','
+			<< ToMilliseconds(stats.inclusiveTime) << ',' << ToMilliseconds(GetExclusiveTime(pBehavior)) << ','
+			<< stats.hostCalls << ',' << GetExclusiveHostCalls(pBehavior) << '\n';
+
+		for (int i = 0; i < pBehavior->GetChildCount(); ++i)
+			ExportNode(file, pBehavior->GetChild(i), path, i);
+	}
+}
+
+void Elite::RenderBehaviorProfiler(IBehavior* pRoot)
+{
+	if (pRoot == nullptr)
+		return;
+
+	ImGui::SetNextWindowSize(ImVec2(720, 420), ImGuiSetCond_FirstUseEver);
+	if (!ImGui::Begin("Behavior Tree Profiler"))
+	{
+		ImGui::End();
+		return;
+	}
+
+	//The root ticks once per frame
+	const BehaviorStats& rootStats{ pRoot->GetStats() };
+	ImGui::Text("%u frames, %.3f ms per frame", rootStats.ticks,
+		rootStats.ticks > 0 ? ToMilliseconds(rootStats.inclusiveTime) / static_cast<float>(rootStats.ticks) : 0.f);
+	if (ImGui::Button("Reset"))
+		pRoot->ResetStats();
+	ImGui::SameLine();
+	if (ImGui::Button("Export CSV"))
+	{
+		if (ExportBehaviorProfile(pRoot, "BehaviorProfile.csv"))
+			printf("Behavior profile written to BehaviorProfile.csv\n");
+		else
+			printf("Could not write BehaviorProfile.csv\n");
+	}
+	ImGui::Separator();
+
+	ImGui::Columns(7, "BehaviorProfilerColumns");
+	ImGui::Text("Node"); ImGui::NextColumn();
+	ImGui::Text("Ticks"); ImGui::NextColumn();
+	ImGui::Text("S / F / R"); ImGui::NextColumn();
+	ImGui::Text("Incl ms"); ImGui::NextColumn();
+	ImGui::Text("Excl ms"); ImGui::NextColumn();
+	ImGui::Text("Excl %%"); ImGui::NextColumn();
+	ImGui::Text("Host calls"); ImGui::NextColumn();
+	ImGui::Separator();
+	RenderNode(pRoot, rootStats.inclusiveTime);
+	ImGui::Columns(1);
+
+	ImGui::End();
+}
+
+bool Elite::ExportBehaviorProfile(const IBehavior* pRoot, const std::string& path)
+{
+	std::ofstream file{ path };
+	if (!file)
+		return false;
+
+	file << "node,ticks,successes,failures,running,inclusive_ms,exclusive_ms,host_calls,exclusive_host_calls\n";
+	if (pRoot != nullptr)
+		ExportNode(file, pRoot, "", 0);
+	return static_cast<bool>(file);
+}
+#endif
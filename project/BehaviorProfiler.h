@@ -0,0 +1,92 @@
+#pragma once
+#include "Exam_HelperStructs.h"
+#include "BehaviorTree.h"
+#include "IExamInterface.h"
+
+#ifdef ELITE_BT_PROFILER
+namespace Elite
+{
+	// Exam interface that counts every call and passes it on, the tree gets this one through the blackboard
+	// so the profiler can show how many host calls every node makes
+	class ProfiledExamInterface final : public IExamInterface
+	{
+	public:
+		explicit ProfiledExamInterface(IExamInterface* pInterface) : m_pInterface(pInterface) {}
+
+		//WORLD & ENTITIES
+		WorldInfo World_GetInfo() const override { return Count()->World_GetInfo(); }
+		StatisticsInfo World_GetStats() const override { return Count()->World_GetStats(); }
+		bool Fov_GetHouseByIndex(UINT index, HouseInfo& houseInfo) const override { return Count()->Fov_GetHouseByIndex(index, houseInfo); }
+		bool Fov_GetEntityByIndex(UINT index, EntityInfo& enemyInfo) const override { return Count()->Fov_GetEntityByIndex(index, enemyInfo); }
+		AgentInfo Agent_GetInfo() const override { return Count()->Agent_GetInfo(); }
+		bool Enemy_GetInfo(EntityInfo entity, EnemyInfo& enemy) override { return Count()->Enemy_GetInfo(entity, enemy); }
+
+		//NAVMESH
+		Elite::Vector2 NavMesh_GetClosestPathPoint(Elite::Vector2 goal) const override { return Count()->NavMesh_GetClosestPathPoint(goal); }
+
+		//INVENTORY
+		bool Inventory_AddItem(UINT slotId, ItemInfo item) override { return Count()->Inventory_AddItem(slotId, item); }
+		bool Inventory_UseItem(UINT slotId) override { return Count()->Inventory_UseItem(slotId); }
+		bool Inventory_RemoveItem(UINT slotId) override { return Count()->Inventory_RemoveItem(slotId); }
+		bool Inventory_GetItem(UINT slotId, ItemInfo& item) override { return Count()->Inventory_GetItem(slotId, item); }
+		UINT Inventory_GetCapacity() const override { return Count()->Inventory_GetCapacity(); }
+
+		//ITEMS
+		bool Item_GetInfo(EntityInfo entity, ItemInfo& item) override { return Count()->Item_GetInfo(entity, item); }
+		bool Item_Grab(EntityInfo entity, ItemInfo& item) override { return Count()->Item_Grab(entity, item); }
+		bool Item_Destroy(EntityInfo entity) override { return Count()->Item_Destroy(entity); }
+		int Weapon_GetAmmo(ItemInfo& item) override { return Count()->Weapon_GetAmmo(item); }
+		int Medkit_GetHealth(ItemInfo& item) override { return Count()->Medkit_GetHealth(item); }
+		int Food_GetEnergy(ItemInfo& item) override { return Count()->Food_GetEnergy(item); }
+
+		//PURGEZONE
+		bool PurgeZone_GetInfo(EntityInfo entity, PurgeZoneInfo& zone) override { return Count()->PurgeZone_GetInfo(entity, zone); }
+
+		//DEBUG
+		Elite::Vector2 Debug_ConvertScreenToWorld(Elite::Vector2 screenPos) const override { return Count()->Debug_ConvertScreenToWorld(screenPos); }
+		Elite::Vector2 Debug_ConvertWorldToScreen(Elite::Vector2 worldPos) const override { return Count()->Debug_ConvertWorldToScreen(worldPos); }
+
+		//INPUT
+		bool Input_IsKeyboardKeyDown(Elite::InputScancode key) const override { return Count()->Input_IsKeyboardKeyDown(key); }
+		bool Input_IsKeyboardKeyUp(Elite::InputScancode key) const override { return Count()->Input_IsKeyboardKeyUp(key); }
+		bool Input_IsMouseButtonDown(Elite::InputMouseButton button) const override { return Count()->Input_IsMouseButtonDown(button); }
+		bool Input_IsMouseButtonUp(Elite::InputMouseButton button) const override { return Count()->Input_IsMouseButtonUp(button); }
+		Elite::MouseData Input_GetMouseData(Elite::InputType type, Elite::InputMouseButton button) const override { return Count()->Input_GetMouseData(type, button); }
+
+		//EVENT
+		void RequestShutdown() const override { Count()->RequestShutdown(); }
+
+		//RENDERER
+		using IBaseInterface::Draw_Polygon;
+		using IBaseInterface::Draw_SolidPolygon;
+		using IBaseInterface::Draw_Circle;
+		using IBaseInterface::Draw_SolidCircle;
+		using IBaseInterface::Draw_Segment;
+		using IBaseInterface::Draw_Transform;
+		using IBaseInterface::Draw_Point;
+		void Draw_Polygon(const Elite::Vector2* points, int count, const Elite::Vector3& color, float depth) override { Count()->Draw_Polygon(points, count, color, depth); }
+		void Draw_SolidPolygon(const Elite::Vector2* points, int count, const Elite::Vector3& color, float depth, bool triangulate) override { Count()->Draw_SolidPolygon(points, count, color, depth, triangulate); }
+		void Draw_Circle(const Elite::Vector2& center, float radius, const Elite::Vector3& color, float depth) override { Count()->Draw_Circle(center, radius, color, depth); }
+		void Draw_SolidCircle(const Elite::Vector2& center, float32 radius, const Elite::Vector2& axis, const Elite::Vector3& color, float depth) override { Count()->Draw_SolidCircle(center, radius, axis, color, depth); }
+		void Draw_Segment(const Elite::Vector2& p1, const Elite::Vector2& p2, const Elite::Vector3& color, float depth) override { Count()->Draw_Segment(p1, p2, color, depth); }
+		void Draw_Direction(const Elite::Vector2& p, Elite::Vector2 dir, float length, const Elite::Vector3& color, float depth) override { Count()->Draw_Direction(p, dir, length, color, depth); }
+		void Draw_Transform(const b2Transform& xf, float depth) override { Count()->Draw_Transform(xf, depth); }
+		void Draw_Point(const Elite::Vector2& p, float size, const Elite::Vector3& color, float depth) override { Count()->Draw_Point(p, size, color, depth); }
+		float NextDepthSlice() override { return Count()->NextDepthSlice(); }
+
+	private:
+		IExamInterface* Count() const
+		{
+			++BehaviorStats::s_HostCallCount;
+			return m_pInterface;
+		}
+
+		IExamInterface* m_pInterface;
+	};
+
+	// ImGui window with the statistics of every node of the tree, with buttons to reset them and to export them
+	void RenderBehaviorProfiler(IBehavior* pRoot);
+	// One line per node: path, ticks, results, times in ms and host calls. False when the file can't be written
+	bool ExportBehaviorProfile(const IBehavior* pRoot, const std::string& path);
+}
+#endif
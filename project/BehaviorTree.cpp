@@ -3,6 +3,10 @@
 #include "BehaviorTree.h"
 using namespace Elite;
 
+#ifdef ELITE_BT_PROFILER
+uint64_t BehaviorStats::s_HostCallCount = 0;
+#endif
+
 //-----------------------------------------------------------------
 // BEHAVIOR TREE COMPOSITES (IBehavior)
 //-----------------------------------------------------------------
@@ -15,7 +19,7 @@ BehaviorState BehaviorSelector::Execute(Blackboard* pBlackBoard)
 	for (auto& child : m_ChildBehaviors)
 	{
 		//Every Child: Execute and store the result in m_CurrentState
-		m_CurrentState = child->Execute(pBlackBoard);
+		m_CurrentState = child->Tick(pBlackBoard);
 
 		if (m_CurrentState == BehaviorState::Success)
 		{
@@ -51,7 +55,7 @@ BehaviorState BehaviorSequence::Execute(Blackboard* pBlackBoard)
 	for (auto& child : m_ChildBehaviors)
 	{
 		//Every Child: Execute and store the result in m_CurrentState
-		m_CurrentState = child->Execute(pBlackBoard);
+		m_CurrentState = child->Tick(pBlackBoard);
 
 		//Check the currentstate and apply the sequence Logic:
 		switch (m_CurrentState)
@@ -77,7 +81,7 @@ BehaviorState BehaviorPartialSequence::Execute(Blackboard* pBlackBoard)
 {
 	while (m_CurrentBehaviorIndex < m_ChildBehaviors.size())
 	{
-		m_CurrentState = m_ChildBehaviors[m_CurrentBehaviorIndex]->Execute(pBlackBoard);
+		m_CurrentState = m_ChildBehaviors[m_CurrentBehaviorIndex]->Tick(pBlackBoard);
 		switch (m_CurrentState)
 		{
 		case BehaviorState::Failure:
@@ -10,8 +10,15 @@
 //--- Includes ---
 #include "blackboard.h"
 #include <functional>
+#include <chrono>
 #include "DecisionMaking.h"
 
+//Per node statistics, only in debug builds (define ELITE_NO_BT_PROFILER to turn them off there too).
+//Without it Tick is just Execute and the counters don't exist.
+#if defined(_DEBUG) && !defined(ELITE_NO_BT_PROFILER)
+#define ELITE_BT_PROFILER
+#endif
+
 namespace Elite
 {
 	//-----------------------------------------------------------------
@@ -24,6 +31,21 @@ namespace Elite
 		Running
 	};
 
+#ifdef ELITE_BT_PROFILER
+	struct BehaviorStats
+	{
+		uint32_t ticks = 0;
+		uint32_t successes = 0;
+		uint32_t failures = 0;
+		uint32_t running = 0;
+		uint64_t inclusiveTime = 0; //nanoseconds, the node and its children
+		uint64_t hostCalls = 0; //calls into the exam interface, the node and its children
+
+		//Host calls made by the plugin so far, counted by ProfiledExamInterface
+		static uint64_t s_HostCallCount;
+	};
+#endif
+
 	//-----------------------------------------------------------------
 	// BEHAVIOR INTERFACES (BASE)
 	//-----------------------------------------------------------------
@@ -34,8 +56,49 @@ namespace Elite
 		virtual ~IBehavior() = default;
 		virtual BehaviorState Execute(Blackboard* pBlackBoard) = 0;
 
+		//Execute with the statistics around it, parents tick their children through this
+		BehaviorState Tick(Blackboard* pBlackBoard)
+		{
+#ifdef ELITE_BT_PROFILER
+			const auto start = std::chrono::steady_clock::now();
+			const uint64_t hostCalls = BehaviorStats::s_HostCallCount;
+			const BehaviorState state = Execute(pBlackBoard);
+			m_Stats.inclusiveTime += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+			m_Stats.hostCalls += BehaviorStats::s_HostCallCount - hostCalls;
+			++m_Stats.ticks;
+			switch (state)
+			{
+			case BehaviorState::Success: ++m_Stats.successes; break;
+			case BehaviorState::Failure: ++m_Stats.failures; break;
+			case BehaviorState::Running: ++m_Stats.running; break;
+			}
+			return state;
+#else
+			return Execute(pBlackBoard);
+#endif
+		}
+
+		virtual const char* GetName() const = 0;
+		virtual int GetChildCount() const { return 0; }
+		virtual IBehavior* GetChild(int index) const { return nullptr; }
+
+#ifdef ELITE_BT_PROFILER
+		const BehaviorStats& GetStats() const { return m_Stats; }
+		void ResetStats()
+		{
+			m_Stats = BehaviorStats{};
+			for (int i = 0; i < GetChildCount(); ++i)
+				GetChild(i)->ResetStats();
+		}
+#endif
+
 	protected:
 		BehaviorState m_CurrentState = BehaviorState::Failure;
+
+#ifdef ELITE_BT_PROFILER
+	private:
+		BehaviorStats m_Stats{};
+#endif
 	};
 
 	//-----------------------------------------------------------------
@@ -60,6 +123,9 @@ namespace Elite
 
 		virtual BehaviorState Execute(Blackboard* pBlackBoard) override = 0;
 
+		virtual int GetChildCount() const override { return static_cast<int>(m_ChildBehaviors.size()); }
+		virtual IBehavior* GetChild(int index) const override { return m_ChildBehaviors[index]; }
+
 	protected:
 		std::vector<IBehavior*> m_ChildBehaviors = {};
 	};
@@ -73,6 +139,7 @@ namespace Elite
 		virtual ~BehaviorSelector() = default;
 
 		virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+		virtual const char* GetName() const override { return "Selector"; }
 	};
 
 	//--- SEQUENCE ---
@@ -84,6 +151,7 @@ namespace Elite
 		virtual ~BehaviorSequence() = default;
 
 		virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+		virtual const char* GetName() const override { return "Sequence"; }
 	};
 
 	//--- PARTIAL SEQUENCE ---
@@ -95,6 +163,7 @@ namespace Elite
 		virtual ~BehaviorPartialSequence() = default;
 
 		virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+		virtual const char* GetName() const override { return "Partial sequence"; }
 
 	private:
 		unsigned int m_CurrentBehaviorIndex = 0;
@@ -107,11 +176,14 @@ namespace Elite
 	class BehaviorConditional : public IBehavior
 	{
 	public:
-		explicit BehaviorConditional(std::function<bool(Blackboard*)> fp) : m_fpConditional(fp) {}
+		explicit BehaviorConditional(std::function<bool(Blackboard*)> fp, const char* name = "Conditional")
+			: m_fpConditional(fp), m_Name(name) {}
 		virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+		virtual const char* GetName() const override { return m_Name; }
 
 	private:
 		std::function<bool(Blackboard*)> m_fpConditional = nullptr;
+		const char* m_Name = nullptr;
 	};
 
 	//-----------------------------------------------------------------
@@ -120,11 +192,14 @@ namespace Elite
 	class BehaviorAction : public IBehavior
 	{
 	public:
-		explicit BehaviorAction(std::function<BehaviorState(Blackboard*)> fp) : m_fpAction(fp) {}
+		explicit BehaviorAction(std::function<BehaviorState(Blackboard*)> fp, const char* name = "Action")
+			: m_fpAction(fp), m_Name(name) {}
 		virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+		virtual const char* GetName() const override { return m_Name; }
 
 	private:
 		std::function<BehaviorState(Blackboard*)> m_fpAction = nullptr;
+		const char* m_Name = nullptr;
 	};
 
 	//-----------------------------------------------------------------
@@ -150,12 +225,16 @@ namespace Elite
 				return;
 			}
 
-			m_CurrentState = m_pRootBehavior->Execute(m_pBlackBoard);
+			m_CurrentState = m_pRootBehavior->Tick(m_pBlackBoard);
 		}
 		Blackboard* GetBlackboard() const
 		{
 			return m_pBlackBoard;
 		}
+		IBehavior* GetRoot() const
+		{
+			return m_pRootBehavior;
+		}
 
 	private:
 		BehaviorState m_CurrentState = BehaviorState::Failure;
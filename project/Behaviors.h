@@ -13,6 +13,9 @@
 #include "IExamInterface.h"
 
 #include "BehaviorTree.h"
+#include "NavMesh.h"
+#include "LineOfSight.h"
+#include "DistanceTable.h"
 
 //-----------------------------------------------------------------
 // Behaviors
@@ -20,10 +23,14 @@
 
 namespace BT_Actions
 {
-	void MoveTowardsPoint(IExamInterface* pInterface, SteeringPlugin_Output* steering, const Elite::Vector2& dest)
+	void MoveTowardsPoint(IExamInterface* pInterface, Elite::NavMesh* pNavMesh, SteeringPlugin_Output* steering, const Elite::Vector2& dest)
 	{
 		auto agentInfo = pInterface->Agent_GetInfo();
-		auto nextTargetPos = pInterface->NavMesh_GetClosestPathPoint(dest);
+
+		//Use our own navmesh path, if it can't reach the destination (e.g. inside a house) let the host navmesh handle it
+		Elite::Vector2 nextTargetPos{};
+		if (pNavMesh == nullptr || !pNavMesh->GetNextPathPoint(agentInfo.Position, dest, nextTargetPos))
+			nextTargetPos = pInterface->NavMesh_GetClosestPathPoint(dest);
 
 		//Simple Seek Behaviour (towards Target)
 		std::cout << "GOING TO " << nextTargetPos << '\n';
@@ -32,6 +39,54 @@ namespace BT_Actions
 		steering->LinearVelocity *= agentInfo.MaxLinearSpeed; //Rescale to Max Speed
 	}
 
+	//Closest enemy in the FOV that is not behind a wall, the lines to all of them are checked in one batch.
+	//The walls are guessed (no doors), so when every enemy looks blocked the closest one is still the target
+	bool GetTargetEnemy(IExamInterface* pInterface, const Elite::LineOfSight* pLineOfSight, const std::vector<EntityInfo>& entities, EnemyInfo& target)
+	{
+		const Elite::Vector2 agentPosition{ pInterface->Agent_GetInfo().Position };
+
+		std::vector<EnemyInfo> enemies{};
+		std::vector<Elite::Vector2> enemyLocations{};
+		EnemyInfo enemyInfo{};
+		for (const EntityInfo& info : entities)
+		{
+			if (!pInterface->Enemy_GetInfo(info, enemyInfo))
+				continue;
+			enemies.push_back(enemyInfo);
+			enemyLocations.push_back(enemyInfo.Location);
+		}
+
+		std::vector<uint8_t> isBlocked(enemies.size(), 0);
+		if (pLineOfSight != nullptr)
+			pLineOfSight->AreBlocked(agentPosition, enemyLocations, isBlocked);
+
+		int closestIndex{ -1 };
+		int closestVisibleIndex{ -1 };
+		float closestDistanceSquared{ FLT_MAX };
+		float closestVisibleDistanceSquared{ FLT_MAX };
+		for (size_t i = 0; i < enemies.size(); ++i)
+		{
+			const float distanceSquared{ Elite::DistanceSquared(agentPosition, enemies[i].Location) };
+			if (distanceSquared < closestDistanceSquared)
+			{
+				closestDistanceSquared = distanceSquared;
+				closestIndex = static_cast<int>(i);
+			}
+			if (!isBlocked[i] && distanceSquared < closestVisibleDistanceSquared)
+			{
+				closestVisibleDistanceSquared = distanceSquared;
+				closestVisibleIndex = static_cast<int>(i);
+			}
+		}
+
+		if (closestVisibleIndex != -1)
+			closestIndex = closestVisibleIndex;
+		if (closestIndex == -1)
+			return false;
+		target = enemies[closestIndex];
+		return true;
+	}
+
 	
 	Elite::BehaviorState TurnAndShoot(Elite::Blackboard* pBlackboard)
 	{
@@ -54,18 +109,20 @@ namespace BT_Actions
 			return Elite::BehaviorState::Failure;
 		}
 
+		Elite::LineOfSight* pLineOfSight{};
+		pBlackboard->GetData("LineOfSight", pLineOfSight);
+
 		EnemyInfo enemyInfo{};
-		for (const EntityInfo& info : *entityVec)
+		if (!GetTargetEnemy(examInterface, pLineOfSight, *entityVec, enemyInfo))
 		{
-			examInterface->Enemy_GetInfo(info, enemyInfo);
+			return Elite::BehaviorState::Failure;
 		}
 
 		steering->AutoOrient = false;
 
 		constexpr float angularSpeed{ 2.f };
-		if (AngleBetween(	Elite::Vector2(cosf(agentInfo.Orientation), sinf(agentInfo.Orientation)),
-							enemyInfo.Location - agentInfo.Position)
-			< 0.f)
+		const float angleToEnemy{ AngleBetween(Elite::OrientationToVector(agentInfo.Orientation), enemyInfo.Location - agentInfo.Position) };
+		if (angleToEnemy < 0.f)
 		{
 			steering->AngularVelocity -= angularSpeed;
 		}
@@ -75,9 +132,7 @@ namespace BT_Actions
 		}
 
 		//if the angle is small enough
-		if (fabs(AngleBetween(	Elite::Vector2(cosf(agentInfo.Orientation), sinf(agentInfo.Orientation)),
-								enemyInfo.Location - agentInfo.Position))
-			<= 0.05f)
+		if (fabs(angleToEnemy) <= 0.05f)
 		{
 			ItemInfo occupiedItemInfo{};
 			//Try to shoot shotgun
@@ -164,11 +219,10 @@ namespace BT_Actions
 		}
 		const AgentInfo agentInfo = examInterface->Agent_GetInfo();
 
-		const Elite::Vector2 moveDir{ agentInfo.Position.x + 2.5f * cosf(agentInfo.Orientation),
-								agentInfo.Position.y + 2.5f * sinf(agentInfo.Orientation) };
+		const Elite::Vector2 moveDir{ agentInfo.Position + 2.5f * Elite::OrientationToVector(agentInfo.Orientation) };
 
 		//std::cout << "Getting unstuck\n";
-		MoveTowardsPoint(examInterface, steering, moveDir);
+		MoveTowardsPoint(examInterface, nullptr, steering, moveDir); //Straight ahead, no pathfinding
 		return Elite::BehaviorState::Success;
 	}
 
@@ -185,6 +239,12 @@ namespace BT_Actions
 		{
 			return Elite::BehaviorState::Failure;
 		}
+
+		Elite::NavMesh* navMesh;
+		if (!pBlackboard->GetData("NavMesh", navMesh) || navMesh == nullptr)
+		{
+			return Elite::BehaviorState::Failure;
+		}
 		const AgentInfo agentInfo = examInterface->Agent_GetInfo();
 
 		std::deque<Elite::Vector2>* wanderPointsVector;
@@ -238,7 +298,7 @@ namespace BT_Actions
 		steering->RunMode = *isRunning;
 
 		//std::cout << "Wandering\n";
-		MoveTowardsPoint(examInterface, steering, (*wanderPointsVector)[0]);
+		MoveTowardsPoint(examInterface, navMesh, steering, (*wanderPointsVector)[0]);
 		return Elite::BehaviorState::Success;
 	}
 
@@ -256,6 +316,12 @@ namespace BT_Actions
 			return Elite::BehaviorState::Failure;
 		}
 
+		Elite::NavMesh* navMesh;
+		if (!pBlackboard->GetData("NavMesh", navMesh) || navMesh == nullptr)
+		{
+			return Elite::BehaviorState::Failure;
+		}
+
 		std::vector<Elite::Vector2>* visitedHouseCenters;
 		if (!pBlackboard->GetData("VisitedHouseCenters", visitedHouseCenters) || visitedHouseCenters == nullptr)
 		{
@@ -271,7 +337,7 @@ namespace BT_Actions
 
 		if (houseCentersToVisit->size() != 0)
 		{
-			MoveTowardsPoint(examInterface, steering, (*houseCentersToVisit)[0]);
+			MoveTowardsPoint(examInterface, navMesh, steering, (*houseCentersToVisit)[0]);
 			return Elite::BehaviorState::Success;
 		}
 
@@ -293,6 +359,12 @@ namespace BT_Actions
 			return Elite::BehaviorState::Failure;
 		}
 
+		Elite::NavMesh* navMesh;
+		if (!pBlackboard->GetData("NavMesh", navMesh) || navMesh == nullptr)
+		{
+			return Elite::BehaviorState::Failure;
+		}
+
 		std::deque<EntityInfo>* itemsToVisit;
 		if (!pBlackboard->GetData("ItemsToVisit", itemsToVisit) || itemsToVisit == nullptr)
 		{
@@ -300,7 +372,7 @@ namespace BT_Actions
 		}
 
 		//std::cout << "GoingToItem\n";
-		MoveTowardsPoint(examInterface, steering, (*itemsToVisit)[0].Location);
+		MoveTowardsPoint(examInterface, navMesh, steering, (*itemsToVisit)[0].Location);
 		return Elite::BehaviorState::Success;
 	}
 
@@ -483,6 +555,12 @@ namespace BT_Actions
 		{
 			return Elite::BehaviorState::Failure;
 		}
+
+		Elite::NavMesh* navMesh;
+		if (!pBlackboard->GetData("NavMesh", navMesh) || navMesh == nullptr)
+		{
+			return Elite::BehaviorState::Failure;
+		}
 		const AgentInfo agentInfo = examInterface->Agent_GetInfo();
 
 		std::vector<EntityInfo>* entityVec;
@@ -536,7 +614,109 @@ namespace BT_Actions
 		steering->RunMode = true;
 
 
-		MoveTowardsPoint(examInterface, steering, goToPoint);
+		MoveTowardsPoint(examInterface, navMesh, steering, goToPoint);
+		return Elite::BehaviorState::Success;
+	}
+
+	//Inputs of the learned steering policy, in the frame of the agent (x forward, y to the side):
+	//the agent velocity / max speed, then for the closest PolicyEnemyCount enemies
+	//the position / FOV range and the velocity / max speed, zero when there are fewer enemies.
+	//Outputs: the direction to move in (same frame), the run flag when there is a third output.
+	constexpr int PolicyEnemyCount{ 4 };
+	constexpr int PolicyInputCount{ 2 + 4 * PolicyEnemyCount };
+	//forward, side and optionally run
+	constexpr int PolicyOutputCount{ 3 };
+
+	void GetPolicyInputs(IExamInterface* pInterface, const AgentInfo& agentInfo, const std::vector<EntityInfo>& entities, float* pInputs)
+	{
+		const Elite::Vector2 forward{ Elite::OrientationToVector(agentInfo.Orientation) };
+		const Elite::Vector2 side{ -forward.y, forward.x };
+		const float inverseRange{ 1.f / agentInfo.FOV_Range };
+		const float inverseSpeed{ 1.f / agentInfo.MaxLinearSpeed };
+
+		//Keep the closest PolicyEnemyCount enemies sorted on distance, this runs every tick so nothing gets allocated
+		EnemyInfo enemies[PolicyEnemyCount]{};
+		float distancesSquared[PolicyEnemyCount]{};
+		size_t enemyCount{ 0 };
+		EnemyInfo enemyInfo{};
+		for (const EntityInfo& info : entities)
+		{
+			if (!pInterface->Enemy_GetInfo(info, enemyInfo))
+				continue;
+
+			const float distanceSquared{ Elite::DistanceSquared(agentInfo.Position, enemyInfo.Location) };
+			if (enemyCount == PolicyEnemyCount && distanceSquared >= distancesSquared[enemyCount - 1])
+				continue;
+
+			//Shift the farther ones back (the last one drops off when full) and insert
+			size_t i{ enemyCount < PolicyEnemyCount ? enemyCount++ : enemyCount - 1 };
+			for (; i > 0 && distancesSquared[i - 1] > distanceSquared; --i)
+			{
+				enemies[i] = enemies[i - 1];
+				distancesSquared[i] = distancesSquared[i - 1];
+			}
+			enemies[i] = enemyInfo;
+			distancesSquared[i] = distanceSquared;
+		}
+
+		std::fill(pInputs, pInputs + PolicyInputCount, 0.f);
+		pInputs[0] = forward.Dot(agentInfo.LinearVelocity) * inverseSpeed;
+		pInputs[1] = side.Dot(agentInfo.LinearVelocity) * inverseSpeed;
+		for (size_t i = 0; i < enemyCount; ++i)
+		{
+			const Elite::Vector2 toEnemy{ enemies[i].Location - agentInfo.Position };
+			float* pEnemyInputs = pInputs + 2 + 4 * i;
+			pEnemyInputs[0] = forward.Dot(toEnemy) * inverseRange;
+			pEnemyInputs[1] = side.Dot(toEnemy) * inverseRange;
+			pEnemyInputs[2] = forward.Dot(enemies[i].LinearVelocity) * inverseSpeed;
+			pEnemyInputs[3] = side.Dot(enemies[i].LinearVelocity) * inverseSpeed;
+		}
+	}
+
+	Elite::BehaviorState EvadeWithPolicy(Elite::Blackboard* pBlackboard)
+	{
+		SteeringPlugin_Output* steering{};
+		if (!pBlackboard->GetData("Steering", steering) || steering == nullptr)
+		{
+			return Elite::BehaviorState::Failure;
+		}
+
+		IExamInterface* examInterface;
+		if (!pBlackboard->GetData("ExamInterface", examInterface) || examInterface == nullptr)
+		{
+			return Elite::BehaviorState::Failure;
+		}
+		const AgentInfo agentInfo = examInterface->Agent_GetInfo();
+
+		std::vector<EntityInfo>* entityVec;
+		if (!pBlackboard->GetData("EntityInfoVector", entityVec) || entityVec == nullptr)
+		{
+			return Elite::BehaviorState::Failure;
+		}
+
+		Elite::NeuralNetwork* pPolicy{};
+		if (!pBlackboard->GetData("SteeringPolicy", pPolicy) || pPolicy == nullptr || !pPolicy->IsLoaded())
+		{
+			return Elite::BehaviorState::Failure;
+		}
+
+		float inputs[PolicyInputCount]{};
+		float outputs[PolicyOutputCount]{};
+		GetPolicyInputs(examInterface, agentInfo, *entityVec, inputs);
+		//Evaluate writes GetOutputCount() values
+		if (pPolicy->GetOutputCount() > PolicyOutputCount || !pPolicy->Evaluate(inputs, outputs))
+		{
+			return Elite::BehaviorState::Failure;
+		}
+
+		const Elite::Vector2 forward{ Elite::OrientationToVector(agentInfo.Orientation) };
+		const Elite::Vector2 side{ -forward.y, forward.x };
+		steering->LinearVelocity = forward * outputs[0] + side * outputs[1];
+		steering->LinearVelocity.Normalize();
+		steering->LinearVelocity *= agentInfo.MaxLinearSpeed;
+		if (pPolicy->GetOutputCount() > 2)
+			steering->RunMode = outputs[2] > 0.5f;
+
 		return Elite::BehaviorState::Success;
 	}
 
@@ -594,15 +774,12 @@ namespace BT_Conditions
 			return false;
 		}
 
+		//Enemies behind a wall can't be shot
+		Elite::LineOfSight* pLineOfSight{};
+		pBlackboard->GetData("LineOfSight", pLineOfSight);
+
 		EnemyInfo enemyInfo{};
-		bool foundEnemy{ false };
-		for (const EntityInfo& info : *entityVec)
-		{
-			foundEnemy = examInterface->Enemy_GetInfo(info, enemyInfo);
-			if (foundEnemy)
-				break;
-		}
-		if (foundEnemy)
+		if (BT_Actions::GetTargetEnemy(examInterface, pLineOfSight, *entityVec, enemyInfo))
 		{
 			if (examInterface->Inventory_GetItem(0, ItemInfo{}))
 			{
@@ -734,6 +911,9 @@ namespace BT_Conditions
 		}
 		const AgentInfo agentInfo = examInterface->Agent_GetInfo();
 
+		Elite::DistanceTable* pDistanceTable{};
+		pBlackboard->GetData("DistanceTable", pDistanceTable);
+
 		if (houseCentersToVisit->size() > 0)
 		{
 			// Check if bot is in the center of this house
@@ -742,6 +922,18 @@ namespace BT_Conditions
 				// Ignore this house from now on
 				visitedHouseCenters->push_back((*houseCentersToVisit)[0]);
 				houseCentersToVisit->pop_front();
+
+				// Go to the remaining house that is the shortest walk from here, instead of the one seen first
+				if (pDistanceTable != nullptr && houseCentersToVisit->size() > 1)
+				{
+					std::vector<int> candidates{};
+					for (const Elite::Vector2& center : *houseCentersToVisit)
+						candidates.push_back(pDistanceTable->AddNode(center));
+					const int closest{ pDistanceTable->FindClosest(pDistanceTable->AddNode(visitedHouseCenters->back()), candidates) };
+					const auto it{ std::find(candidates.begin(), candidates.end(), closest) };
+					if (it != candidates.end())
+						std::swap((*houseCentersToVisit)[0], (*houseCentersToVisit)[it - candidates.begin()]);
+				}
 				return false;
 			}
 		}
@@ -768,6 +960,8 @@ namespace BT_Conditions
 			if (oneIsEqual == false)
 			{
 				houseCentersToVisit->push_back(houseInfo.Center);
+				if (pDistanceTable != nullptr)
+					pDistanceTable->AddNode(houseInfo.Center);
 			}
 		}
 
@@ -903,6 +1097,35 @@ namespace BT_Conditions
 		return false;
 	}
 
+	bool CanEvadeWithPolicy(Elite::Blackboard* pBlackboard)
+	{
+		Elite::NeuralNetwork* pPolicy{};
+		if (!pBlackboard->GetData("SteeringPolicy", pPolicy) || pPolicy == nullptr || !pPolicy->IsLoaded())
+		{
+			return false;
+		}
+
+		std::vector<EntityInfo>* entityVec;
+		if (!pBlackboard->GetData("EntityInfoVector", entityVec) || entityVec == nullptr)
+		{
+			return false;
+		}
+
+		IExamInterface* examInterface;
+		if (!pBlackboard->GetData("ExamInterface", examInterface) || examInterface == nullptr)
+		{
+			return false;
+		}
+
+		EnemyInfo enemyInfo{};
+		for (const EntityInfo& info : *entityVec)
+		{
+			if (examInterface->Enemy_GetInfo(info, enemyInfo))
+				return true;
+		}
+		return false;
+	}
+
 	bool HasBeenDamaged(Elite::Blackboard* pBlackboard)
 	{
 		IExamInterface* examInterface;
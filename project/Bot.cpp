@@ -16,7 +16,17 @@ Bot::Bot(IExamInterface* pInterface)
 	m_WanderPointsVector = { {0,190}, {190,190}, {190, -190}, {-190,-190}, {-190,190}, {-1000,-1000}, {0,0} };
 	// {-1000,-1000} is the point where the m_VisitedHouseCenters variable gets reset
 	// The agent doesnt actually go to {-1000,-1000}
+	m_DistanceTable.SetNavMesh(&m_NavMesh);
 
+	//The policy is optional, without the file the bot just doesn't evade with it. LoadFromFile reports broken files
+	const std::string policyPath{ "SteeringPolicy.emlp" };
+	if (std::ifstream{ policyPath }.good() && m_SteeringPolicy.LoadFromFile(policyPath)
+		&& (m_SteeringPolicy.GetInputCount() != BT_Actions::PolicyInputCount || m_SteeringPolicy.GetOutputCount() < 2
+			|| m_SteeringPolicy.GetOutputCount() > BT_Actions::PolicyOutputCount))
+	{
+		printf("SteeringPolicy.emlp needs %d inputs and 2 to %d outputs\n", BT_Actions::PolicyInputCount, BT_Actions::PolicyOutputCount);
+		m_SteeringPolicy.Clear();
+	}
 
 	//1. Create Blackboard
 	Blackboard* pBlackboard = CreateBlackboard();
@@ -38,8 +48,8 @@ Bot::Bot(IExamInterface* pInterface)
 					{
 						std::vector<IBehavior*>
 						{
-							new BehaviorConditional{ BT_Conditions::IsLowHP },
-							new BehaviorAction{ BT_Actions::Heal }
+							new BehaviorConditional{ BT_Conditions::IsLowHP, "IsLowHP" },
+							new BehaviorAction{ BT_Actions::Heal, "Heal" }
 						}
 					},
 					//EATING
@@ -47,8 +57,8 @@ Bot::Bot(IExamInterface* pInterface)
 					{
 						std::vector<IBehavior*>
 						{
-							new BehaviorConditional{ BT_Conditions::IsHungry },
-							new BehaviorAction{ BT_Actions::Eat }
+							new BehaviorConditional{ BT_Conditions::IsHungry, "IsHungry" },
+							new BehaviorAction{ BT_Actions::Eat, "Eat" }
 						}
 					}
 				}
@@ -60,8 +70,8 @@ Bot::Bot(IExamInterface* pInterface)
 				{
 					std::vector<IBehavior*>
 					{
-						new BehaviorConditional{ BT_Conditions::HasEnemyInVision },
-						new BehaviorAction{ BT_Actions::TurnAndShoot }
+						new BehaviorConditional{ BT_Conditions::HasEnemyInVision, "HasEnemyInVision" },
+						new BehaviorAction{ BT_Actions::TurnAndShoot, "TurnAndShoot" }
 					}
 				},
 				//AVOID PURGE ZONE
@@ -69,8 +79,17 @@ Bot::Bot(IExamInterface* pInterface)
 				{
 					std::vector<IBehavior*>
 					{
-						new BehaviorConditional{ BT_Conditions::SeesPurge },
-						new BehaviorAction{ BT_Actions::AvoidPurge }
+						new BehaviorConditional{ BT_Conditions::SeesPurge, "SeesPurge" },
+						new BehaviorAction{ BT_Actions::AvoidPurge, "AvoidPurge" }
+					}
+				},
+				//EVADE ENEMIES WITH THE LEARNED POLICY
+				new BehaviorSequence
+				{
+					std::vector<IBehavior*>
+					{
+						new BehaviorConditional{ BT_Conditions::CanEvadeWithPolicy, "CanEvadeWithPolicy" },
+						new BehaviorAction{ BT_Actions::EvadeWithPolicy, "EvadeWithPolicy" }
 					}
 				},
 				//IF DAMAGED SEARCH ENEMY
@@ -78,8 +97,8 @@ Bot::Bot(IExamInterface* pInterface)
 				{
 					std::vector<IBehavior*>
 					{
-						new BehaviorConditional{ BT_Conditions::HasBeenDamaged },
-						new BehaviorAction{ BT_Actions::SearchEnemy }
+						new BehaviorConditional{ BT_Conditions::HasBeenDamaged, "HasBeenDamaged" },
+						new BehaviorAction{ BT_Actions::SearchEnemy, "SearchEnemy" }
 					}
 				},
 				
@@ -88,8 +107,8 @@ Bot::Bot(IExamInterface* pInterface)
 				{
 					std::vector<IBehavior*>
 					{
-						new BehaviorConditional{ BT_Conditions::IsStuck },
-						new BehaviorAction{ BT_Actions::MoveStraightForward }
+						new BehaviorConditional{ BT_Conditions::IsStuck, "IsStuck" },
+						new BehaviorAction{ BT_Actions::MoveStraightForward, "MoveStraightForward" }
 					}
 				},
 				//PICK UP ITEM
@@ -97,8 +116,8 @@ Bot::Bot(IExamInterface* pInterface)
 				{
 					std::vector<IBehavior*>
 					{
-						new BehaviorConditional{ BT_Conditions::IsOnItem },
-						new BehaviorAction{ BT_Actions::PickUpItem }
+						new BehaviorConditional{ BT_Conditions::IsOnItem, "IsOnItem" },
+						new BehaviorAction{ BT_Actions::PickUpItem, "PickUpItem" }
 					}
 				},
 				//GOING TO ITEM IN VISION
@@ -106,8 +125,8 @@ Bot::Bot(IExamInterface* pInterface)
 				{
 					std::vector<IBehavior*>
 					{
-						new BehaviorConditional{ BT_Conditions::IsItemInVision },
-						new BehaviorAction{ BT_Actions::GoToItem }
+						new BehaviorConditional{ BT_Conditions::IsItemInVision, "IsItemInVision" },
+						new BehaviorAction{ BT_Actions::GoToItem, "GoToItem" }
 					}
 				},
 				//ENTER HOUSE
@@ -115,12 +134,12 @@ Bot::Bot(IExamInterface* pInterface)
 				{
 					std::vector<IBehavior*>
 					{
-						new BehaviorConditional{ BT_Conditions::IsHouseInVision },
-						new BehaviorAction{ BT_Actions::GoInHouse }
+						new BehaviorConditional{ BT_Conditions::IsHouseInVision, "IsHouseInVision" },
+						new BehaviorAction{ BT_Actions::GoInHouse, "GoInHouse" }
 					}
 				},
 				//WANDER
-				new BehaviorAction{ BT_Actions::Wander }
+				new BehaviorAction{ BT_Actions::Wander, "Wander" }
 			}
 		}
 	);
@@ -134,7 +153,11 @@ Blackboard* Bot::CreateBlackboard()
 	pBlackboard->AddData("Steering", static_cast<SteeringPlugin_Output*>(nullptr));
 	pBlackboard->AddData("EntityInfoVector", &m_EntityInfoVector);
 	pBlackboard->AddData("HouseInfoVector", &m_HouseInfoVector);
+#ifdef ELITE_BT_PROFILER
+	pBlackboard->AddData("ExamInterface", static_cast<IExamInterface*>(&m_ProfiledInterface));
+#else
 	pBlackboard->AddData("ExamInterface", m_IExamInterface);
+#endif
 	pBlackboard->AddData("VisitedHouseCenters", &m_VisitedHouseCenters);
 	pBlackboard->AddData("HouseCentersToVisit", &m_HouseCentersToVisit);
 	pBlackboard->AddData("TimeStuck", &m_TimeStuck);
@@ -147,6 +170,11 @@ Blackboard* Bot::CreateBlackboard()
 	pBlackboard->AddData("PurgeFleeLocation", &m_PurgeFleeLocation);
 	pBlackboard->AddData("TimeSpentSearching", &m_TimeSpentSearching);
 	pBlackboard->AddData("ItemsToVisit", &m_ItemsToVisit);
+	pBlackboard->AddData("NavMesh", &m_NavMesh);
+	pBlackboard->AddData("LineOfSight", &m_LineOfSight);
+	pBlackboard->AddData("DistanceTable", &m_DistanceTable);
+	pBlackboard->AddData("SteeringPolicy", &m_SteeringPolicy);
+	pBlackboard->AddData("DebugDraw", &m_DebugDraw);
 
 	m_pBlackboard = pBlackboard;
 
@@ -157,6 +185,12 @@ void Bot::SetHouseInfoVector(const std::vector<HouseInfo>& houseInfoVector)
 {
 	//if (m_HouseInfoVector != houseInfoVector)
 		m_HouseInfoVector = houseInfoVector;
+
+	for (const HouseInfo& houseInfo : houseInfoVector)
+	{
+		m_NavMesh.AddHouse(houseInfo);
+		m_LineOfSight.AddHouse(houseInfo);
+	}
 }
 
 void Bot::SetEntityInfoVector(const std::vector<EntityInfo>& entityInfoVector)
@@ -173,5 +207,108 @@ void Bot::SetSteeringTarget(SteeringPlugin_Output* steering)
 void Bot::Update(float dt)
 {
 	m_DeltaTime = dt;
+
+	//The world info is not available yet when the bot gets constructed
+	if (!m_NavMesh.IsInitialized())
+		m_NavMesh.Initialize(m_IExamInterface->World_GetInfo(), m_IExamInterface->Agent_GetInfo().AgentSize);
+	if (!m_LineOfSight.IsInitialized())
+		m_LineOfSight.Initialize(m_IExamInterface->World_GetInfo());
+	UpdatePurgeObstacles(dt);
+	m_NavMesh.Update();
+
+	//The wander points are the first nodes, the houses get added as they are seen (IsHouseInVision)
+	if (m_DistanceTable.GetNodeCount() == 0)
+	{
+		for (const Vector2& wanderPoint : m_WanderPointsVector)
+		{
+			if (wanderPoint != Vector2{ -1000, -1000 })
+				m_DistanceTable.AddNode(wanderPoint);
+		}
+	}
+
+	m_DebugDraw.Clear();
 	m_pDecisionMaking->Update(dt);
+	RecordDebugDraw();
+}
+
+#ifdef ELITE_BT_PROFILER
+void Bot::RenderBehaviorProfiler()
+{
+	Elite::RenderBehaviorProfiler(static_cast<BehaviorTree*>(m_pDecisionMaking)->GetRoot());
+}
+#endif
+
+void Bot::UpdatePurgeObstacles(float dt)
+{
+	for (PurgeObstacle& obstacle : m_PurgeObstacles)
+		obstacle.timeSinceSeen += dt;
+
+	PurgeZoneInfo purgeInfo{};
+	for (const EntityInfo& info : m_EntityInfoVector)
+	{
+		if (!m_IExamInterface->PurgeZone_GetInfo(info, purgeInfo))
+			continue;
+
+		auto it = std::find_if(m_PurgeObstacles.begin(), m_PurgeObstacles.end(),
+			[&purgeInfo](const PurgeObstacle& obstacle) { return obstacle.zoneHash == purgeInfo.ZoneHash; });
+		if (it == m_PurgeObstacles.end())
+			m_PurgeObstacles.push_back({ purgeInfo.ZoneHash, m_NavMesh.AddObstacle(purgeInfo.Center, purgeInfo.Radius), 0.f });
+		else
+			it->timeSinceSeen = 0.f;
+	}
+
+	//Same memory as the purge conditions, after that the zone is most likely gone
+	constexpr float forgetTime{ 5.f };
+	for (auto it = m_PurgeObstacles.begin(); it != m_PurgeObstacles.end();)
+	{
+		if (it->timeSinceSeen > forgetTime)
+		{
+			m_NavMesh.RemoveObstacle(it->obstacleId);
+			it = m_PurgeObstacles.erase(it);
+		}
+		else
+			++it;
+	}
+}
+
+void Bot::RecordDebugDraw()
+{
+	//The channel checks also skip the loops, in release they are always false
+	if (m_DebugDraw.IsChannelEnabled(DebugChannel::Navigation))
+	{
+		const std::vector<Vector2>& path{ m_NavMesh.GetCurrentPath() };
+		for (size_t i = 1; i < path.size(); ++i)
+			m_DebugDraw.DrawSegment(DebugChannel::Navigation, path[i - 1], path[i], { 0.f, 1.f, 1.f });
+	}
+
+	if (m_DebugDraw.IsChannelEnabled(DebugChannel::Houses))
+	{
+		for (const HouseInfo& houseInfo : m_HouseInfoVector)
+			m_DebugDraw.DrawRect(DebugChannel::Houses, houseInfo.Center, houseInfo.Size, { 0.f, 1.f, 0.f });
+		for (const Vector2& center : m_HouseCentersToVisit)
+			m_DebugDraw.DrawPoint(DebugChannel::Houses, center, 5.f, { 1.f, 1.f, 0.f });
+		for (const Vector2& center : m_VisitedHouseCenters)
+			m_DebugDraw.DrawPoint(DebugChannel::Houses, center, 5.f, { 0.5f, 0.5f, 0.5f });
+	}
+
+	if (m_DebugDraw.IsChannelEnabled(DebugChannel::Entities))
+	{
+		PurgeZoneInfo purgeInfo{};
+		for (const EntityInfo& info : m_EntityInfoVector)
+		{
+			switch (info.Type)
+			{
+			case eEntityType::ENEMY:
+				m_DebugDraw.DrawCircle(DebugChannel::Entities, info.Location, 1.5f, { 1.f, 0.f, 0.f });
+				break;
+			case eEntityType::ITEM:
+				m_DebugDraw.DrawCircle(DebugChannel::Entities, info.Location, 1.f, { 0.f, 0.5f, 1.f });
+				break;
+			case eEntityType::PURGEZONE:
+				if (m_IExamInterface->PurgeZone_GetInfo(info, purgeInfo))
+					m_DebugDraw.DrawCircle(DebugChannel::Entities, purgeInfo.Center, purgeInfo.Radius, { 1.f, 0.5f, 0.f });
+				break;
+			}
+		}
+	}
 }
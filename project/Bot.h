@@ -1,5 +1,10 @@
 #pragma once
 #include "Exam_HelperStructs.h"
+#include "NavMesh.h"
+#include "LineOfSight.h"
+#include "DistanceTable.h"
+#include "DebugDrawRecorder.h"
+#include "BehaviorProfiler.h"
 
 class IExamInterface;
 namespace Elite
@@ -19,17 +24,45 @@ namespace Elite
 		void SetSteeringTarget(SteeringPlugin_Output* steering);
 
 		void Update(float dt);
+
+		// Recorded in Update, drawn by Plugin::Render
+		DebugDrawRecorder& GetDebugDraw() { return m_DebugDraw; }
+#ifdef ELITE_BT_PROFILER
+		void RenderBehaviorProfiler();
+#endif
 	private:
 		Blackboard* CreateBlackboard();
+		void UpdatePurgeObstacles(float dt);
+		void RecordDebugDraw();
 
 		Blackboard* m_pBlackboard{};
 
 		std::vector<HouseInfo> m_HouseInfoVector{};
 		std::vector<EntityInfo> m_EntityInfoVector{};
 		IExamInterface* m_IExamInterface{};
+#ifdef ELITE_BT_PROFILER
+		// The tree gets this one instead of m_IExamInterface, so the profiler can count the host calls of every node
+		ProfiledExamInterface m_ProfiledInterface{ m_IExamInterface };
+#endif
 
 		std::deque<EntityInfo> m_ItemsToVisit{};
 
+		NavMesh m_NavMesh{};
+		LineOfSight m_LineOfSight{};
+		DistanceTable m_DistanceTable{};
+		// Learned evade policy, optional: the tree skips it when SteeringPolicy.emlp is missing
+		NeuralNetwork m_SteeringPolicy{};
+		DebugDrawRecorder m_DebugDraw{};
+
+		// Purge zones we saw, cut out of the nav mesh until we haven't seen them for a while
+		struct PurgeObstacle
+		{
+			int zoneHash{};
+			int obstacleId{};
+			float timeSinceSeen{};
+		};
+		std::vector<PurgeObstacle> m_PurgeObstacles{};
+
 		std::vector<Vector2> m_VisitedHouseCenters{};
 		std::deque<Vector2> m_HouseCentersToVisit{};
 
@@ -0,0 +1,160 @@
+#include "stdafx.h"
+#include "DebugDrawRecorder.h"
+#include "IExamInterface.h"
+
+using namespace Elite;
+
+DebugDrawRecorder::DebugDrawRecorder()
+{
+	for (bool& isEnabled : m_EnabledChannels)
+		isEnabled = true;
+}
+
+void DebugDrawRecorder::Clear()
+{
+	m_Circles.clear();
+	m_Segments.clear();
+	m_Polygons.clear();
+	m_PolygonPoints.clear();
+	m_Points.clear();
+}
+
+void DebugDrawRecorder::Flush(IExamInterface* pInterface)
+{
+	m_RecordedCount = static_cast<int>(m_Circles.size() + m_Segments.size() + m_Polygons.size() + m_Points.size());
+	m_CulledCount = 0;
+	m_DrawCallCount = 0;
+	if (m_RecordedCount == 0)
+		return;
+
+	//Corners of the screen in the world, y flips between the two so take the min and max
+	const ImVec2 screenSize{ ImGui::GetIO().DisplaySize };
+	if (screenSize.x > 0.f && screenSize.y > 0.f)
+	{
+		const Vector2 corner1{ pInterface->Debug_ConvertScreenToWorld({ 0.f, 0.f }) };
+		const Vector2 corner2{ pInterface->Debug_ConvertScreenToWorld({ screenSize.x, screenSize.y }) };
+		m_ViewMin = { min(corner1.x, corner2.x), min(corner1.y, corner2.y) };
+		m_ViewMax = { max(corner1.x, corner2.x), max(corner1.y, corner2.y) };
+	}
+	else
+	{
+		m_ViewMin = { -FLT_MAX, -FLT_MAX };
+		m_ViewMax = { FLT_MAX, FLT_MAX };
+	}
+
+	//One depth for the whole pass instead of a NextDepthSlice call per shape
+	const float depth{ pInterface->NextDepthSlice() };
+
+	for (const PolygonCommand& polygon : m_Polygons)
+	{
+		if (!IsInView(polygon.boundsMin, polygon.boundsMax))
+		{
+			++m_CulledCount;
+			continue;
+		}
+		if (polygon.isSolid)
+			pInterface->Draw_SolidPolygon(&m_PolygonPoints[polygon.firstPoint], polygon.count, polygon.color, depth);
+		else
+			pInterface->Draw_Polygon(&m_PolygonPoints[polygon.firstPoint], polygon.count, polygon.color, depth);
+		++m_DrawCallCount;
+	}
+
+	FlushSegments(pInterface, depth);
+
+	for (const CircleCommand& circle : m_Circles)
+	{
+		const Vector2 extent{ circle.radius, circle.radius };
+		if (!IsInView(circle.center - extent, circle.center + extent))
+		{
+			++m_CulledCount;
+			continue;
+		}
+		if (circle.isSolid)
+			pInterface->Draw_SolidCircle(circle.center, circle.radius, { 0.f, 0.f }, circle.color, depth);
+		else
+			pInterface->Draw_Circle(circle.center, circle.radius, circle.color, depth);
+		++m_DrawCallCount;
+	}
+
+	for (const PointCommand& point : m_Points)
+	{
+		if (!IsInView(point.position, point.position))
+		{
+			++m_CulledCount;
+			continue;
+		}
+		pInterface->Draw_Point(point.position, point.size, point.color, depth);
+		++m_DrawCallCount;
+	}
+}
+
+void DebugDrawRecorder::AddPolygon(const Vector2* pPoints, int count, const Vector3& color, bool isSolid)
+{
+	if (count < 2)
+		return;
+
+	PolygonCommand polygon{ static_cast<int>(m_PolygonPoints.size()), count, pPoints[0], pPoints[0], color, isSolid };
+	for (int i = 0; i < count; ++i)
+	{
+		polygon.boundsMin = { min(polygon.boundsMin.x, pPoints[i].x), min(polygon.boundsMin.y, pPoints[i].y) };
+		polygon.boundsMax = { max(polygon.boundsMax.x, pPoints[i].x), max(polygon.boundsMax.y, pPoints[i].y) };
+	}
+	m_PolygonPoints.insert(m_PolygonPoints.end(), pPoints, pPoints + count);
+	m_Polygons.push_back(polygon);
+}
+
+void DebugDrawRecorder::FlushSegments(IExamInterface* pInterface, float depth)
+{
+	constexpr float joinDistanceSquared{ 0.0001f };
+
+	size_t runStart{ 0 };
+	while (runStart < m_Segments.size())
+	{
+		//A run: each segment starts where the one before ended, all in the same color
+		const SegmentCommand& first{ m_Segments[runStart] };
+		Vector2 boundsMin{ min(first.p1.x, first.p2.x), min(first.p1.y, first.p2.y) };
+		Vector2 boundsMax{ max(first.p1.x, first.p2.x), max(first.p1.y, first.p2.y) };
+		size_t runEnd{ runStart + 1 };
+		while (runEnd < m_Segments.size()
+			&& m_Segments[runEnd].color == first.color
+			&& DistanceSquared(m_Segments[runEnd].p1, m_Segments[runEnd - 1].p2) <= joinDistanceSquared)
+		{
+			const Vector2& p2{ m_Segments[runEnd].p2 };
+			boundsMin = { min(boundsMin.x, p2.x), min(boundsMin.y, p2.y) };
+			boundsMax = { max(boundsMax.x, p2.x), max(boundsMax.y, p2.y) };
+			++runEnd;
+		}
+
+		const size_t runLength{ runEnd - runStart };
+		if (!IsInView(boundsMin, boundsMax))
+		{
+			m_CulledCount += static_cast<int>(runLength);
+		}
+		else if (runLength >= 3 && DistanceSquared(m_Segments[runEnd - 1].p2, first.p1) <= joinDistanceSquared)
+		{
+			m_Polyline.clear();
+			for (size_t i = runStart; i < runEnd; ++i)
+				m_Polyline.push_back(m_Segments[i].p1);
+			pInterface->Draw_Polygon(m_Polyline.data(), static_cast<int>(m_Polyline.size()), first.color, depth);
+			++m_DrawCallCount;
+		}
+		else
+		{
+			//Open run: the segments that are in view on their own
+			for (size_t i = runStart; i < runEnd; ++i)
+			{
+				const SegmentCommand& segment{ m_Segments[i] };
+				const Vector2 segmentMin{ min(segment.p1.x, segment.p2.x), min(segment.p1.y, segment.p2.y) };
+				const Vector2 segmentMax{ max(segment.p1.x, segment.p2.x), max(segment.p1.y, segment.p2.y) };
+				if (!IsInView(segmentMin, segmentMax))
+				{
+					++m_CulledCount;
+					continue;
+				}
+				pInterface->Draw_Segment(segment.p1, segment.p2, segment.color, depth);
+				++m_DrawCallCount;
+			}
+		}
+		runStart = runEnd;
+	}
+}
\ No newline at end of file
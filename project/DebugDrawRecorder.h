@@ -0,0 +1,138 @@
+#pragma once
+#include "Exam_HelperStructs.h"
+
+// Debug drawing is only recorded in debug builds, define ELITE_NO_DEBUG_DRAW to turn it off there too.
+// In release IsChannelEnabled is always false, so the recording calls and the loops around them compile away.
+#if defined(_DEBUG) && !defined(ELITE_NO_DEBUG_DRAW)
+#define ELITE_DEBUG_DRAW
+#endif
+
+class IExamInterface;
+namespace Elite
+{
+	enum class DebugChannel
+	{
+		Navigation, // nav mesh path and obstacles
+		Houses,     // houses in view, visited and still to visit
+		Entities,   // enemies, items and purge zones in view
+		Count
+	};
+
+	// Collects the debug drawing of a frame in one array per shape, culls it against the camera view
+	// and draws it from Plugin::Render in one pass. Runs of connected segments of one color that end where they
+	// started become one Draw_Polygon call (the interface has no open polyline, open runs stay segments).
+	class DebugDrawRecorder final
+	{
+	public:
+		DebugDrawRecorder();
+
+		bool IsChannelEnabled(DebugChannel channel) const
+		{
+#ifdef ELITE_DEBUG_DRAW
+			return m_EnabledChannels[static_cast<int>(channel)];
+#else
+			return false;
+#endif
+		}
+		void SetChannelEnabled(DebugChannel channel, bool isEnabled) { m_EnabledChannels[static_cast<int>(channel)] = isEnabled; }
+		void ToggleChannel(DebugChannel channel) { SetChannelEnabled(channel, !m_EnabledChannels[static_cast<int>(channel)]); }
+
+		void DrawCircle(DebugChannel channel, const Vector2& center, float radius, const Vector3& color)
+		{
+			if (IsChannelEnabled(channel))
+				m_Circles.push_back({ center, radius, color, false });
+		}
+		void DrawSolidCircle(DebugChannel channel, const Vector2& center, float radius, const Vector3& color)
+		{
+			if (IsChannelEnabled(channel))
+				m_Circles.push_back({ center, radius, color, true });
+		}
+		void DrawSegment(DebugChannel channel, const Vector2& p1, const Vector2& p2, const Vector3& color)
+		{
+			if (IsChannelEnabled(channel))
+				m_Segments.push_back({ p1, p2, color });
+		}
+		void DrawPolygon(DebugChannel channel, const Vector2* pPoints, int count, const Vector3& color, bool isSolid = false)
+		{
+			if (IsChannelEnabled(channel))
+				AddPolygon(pPoints, count, color, isSolid);
+		}
+		void DrawRect(DebugChannel channel, const Vector2& center, const Vector2& size, const Vector3& color)
+		{
+			if (!IsChannelEnabled(channel))
+				return;
+			const Vector2 half{ size / 2.f };
+			const Vector2 corners[4]{ center - half, { center.x + half.x, center.y - half.y }, center + half, { center.x - half.x, center.y + half.y } };
+			AddPolygon(corners, 4, color, false);
+		}
+		void DrawPoint(DebugChannel channel, const Vector2& position, float size, const Vector3& color)
+		{
+			if (IsChannelEnabled(channel))
+				m_Points.push_back({ position, size, color });
+		}
+
+		// Start of a frame, drops the commands of the last one
+		void Clear();
+		// Draws everything recorded since Clear that is in view, can be called more than once per frame
+		void Flush(IExamInterface* pInterface);
+
+		// Of the last Flush
+		int GetRecordedCount() const { return m_RecordedCount; }
+		int GetCulledCount() const { return m_CulledCount; }
+		int GetDrawCallCount() const { return m_DrawCallCount; }
+
+	private:
+		struct CircleCommand
+		{
+			Vector2 center;
+			float radius;
+			Vector3 color;
+			bool isSolid;
+		};
+		struct SegmentCommand
+		{
+			Vector2 p1;
+			Vector2 p2;
+			Vector3 color;
+		};
+		struct PolygonCommand
+		{
+			int firstPoint; // in m_PolygonPoints
+			int count;
+			Vector2 boundsMin;
+			Vector2 boundsMax;
+			Vector3 color;
+			bool isSolid;
+		};
+		struct PointCommand
+		{
+			Vector2 position;
+			float size;
+			Vector3 color;
+		};
+
+		void AddPolygon(const Vector2* pPoints, int count, const Vector3& color, bool isSolid);
+		void FlushSegments(IExamInterface* pInterface, float depth);
+		bool IsInView(const Vector2& boundsMin, const Vector2& boundsMax) const
+		{
+			return boundsMax.x >= m_ViewMin.x && boundsMin.x <= m_ViewMax.x && boundsMax.y >= m_ViewMin.y && boundsMin.y <= m_ViewMax.y;
+		}
+
+		bool m_EnabledChannels[static_cast<int>(DebugChannel::Count)]{};
+
+		std::vector<CircleCommand> m_Circles{};
+		std::vector<SegmentCommand> m_Segments{};
+		std::vector<PolygonCommand> m_Polygons{};
+		std::vector<Vector2> m_PolygonPoints{};
+		std::vector<PointCommand> m_Points{};
+		std::vector<Vector2> m_Polyline{}; // scratch for merging segments
+
+		// World rect the camera sees, set at the start of every Flush
+		Vector2 m_ViewMin{};
+		Vector2 m_ViewMax{};
+
+		int m_RecordedCount{};
+		int m_CulledCount{};
+		int m_DrawCallCount{};
+	};
+}
\ No newline at end of file
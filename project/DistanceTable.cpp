@@ -0,0 +1,118 @@
+#include "stdafx.h"
+#include "DistanceTable.h"
+#include "NavMesh.h"
+
+using namespace Elite;
+
+constexpr float DistanceTable::Unreachable;
+
+int DistanceTable::AddNode(const Vector2& position)
+{
+	const int existing = FindNode(position);
+	if (existing != -1)
+		return existing;
+
+	std::vector<std::pair<int, float>> links{};
+	GetLinks(position, links);
+
+	const int node = GetNodeCount();
+	Reserve(node + 1);
+	m_Nodes.push_back(position);
+
+	//Shortest distance from the new node: over one of its links, then the known shortest distance from there
+	Distance(node, node) = 0.f;
+	for (int other = 0; other < node; ++other)
+	{
+		float distance{ Unreachable };
+		for (const std::pair<int, float>& link : links)
+		{
+			const float viaLink{ GetDistance(link.first, other) };
+			if (viaLink != Unreachable)
+				distance = min(distance, link.second + viaLink);
+		}
+		Distance(node, other) = distance;
+		Distance(other, node) = distance;
+	}
+
+	//The only new paths between the old nodes go through the new one (one Floyd-Warshall step)
+	for (int from = 0; from < node; ++from)
+	{
+		const float toNode{ GetDistance(from, node) };
+		if (toNode == Unreachable)
+			continue;
+
+		float* pRow = &Distance(from, 0);
+		const float* pNodeRow = &Distance(node, 0);
+		for (int to = 0; to < node; ++to)
+		{
+			if (pNodeRow[to] != Unreachable)
+				pRow[to] = min(pRow[to], toNode + pNodeRow[to]);
+		}
+	}
+	return node;
+}
+
+int DistanceTable::FindNode(const Vector2& position) const
+{
+	constexpr float delta{ 1.f };
+	for (size_t i = 0; i < m_Nodes.size(); ++i)
+	{
+		if (DistanceSquared(m_Nodes[i], position) <= delta)
+			return static_cast<int>(i);
+	}
+	return -1;
+}
+
+int DistanceTable::FindClosest(int from, const std::vector<int>& candidates) const
+{
+	int closest{ -1 };
+	float closestDistance{ Unreachable };
+	for (const int candidate : candidates)
+	{
+		const float distance{ GetDistance(from, candidate) };
+		if (distance < closestDistance)
+		{
+			closestDistance = distance;
+			closest = candidate;
+		}
+	}
+	return closest;
+}
+
+void DistanceTable::Reserve(int nodeCount)
+{
+	if (nodeCount <= m_Capacity)
+		return;
+
+	const int capacity{ max(nodeCount, max(2 * m_Capacity, 16)) };
+	std::vector<float> distances(static_cast<size_t>(capacity) * capacity, Unreachable);
+	for (int from = 0; from < GetNodeCount(); ++from)
+	{
+		for (int to = 0; to < GetNodeCount(); ++to)
+			distances[from * capacity + to] = GetDistance(from, to);
+	}
+	m_Distances.swap(distances);
+	m_Capacity = capacity;
+}
+
+void DistanceTable::GetLinks(const Vector2& position, std::vector<std::pair<int, float>>& links) const
+{
+	//Straight distance first, the nav mesh estimate only for the nodes that get linked
+	std::vector<std::pair<float, int>> byDistance{};
+	byDistance.reserve(m_Nodes.size());
+	for (size_t i = 0; i < m_Nodes.size(); ++i)
+		byDistance.push_back({ DistanceSquared(position, m_Nodes[i]), static_cast<int>(i) });
+	std::sort(byDistance.begin(), byDistance.end());
+
+	const float linkRangeSquared{ Square(m_LinkRange) };
+	for (size_t i = 0; i < byDistance.size(); ++i)
+	{
+		if (static_cast<int>(i) >= MinLinkCount && byDistance[i].first > linkRangeSquared)
+			break;
+
+		const Vector2& other{ m_Nodes[byDistance[i].second] };
+		const float distance{ m_pNavMesh != nullptr ? m_pNavMesh->EstimateDistance(position, other) : sqrtf(byDistance[i].first) };
+		if (distance != FLT_MAX)
+			links.push_back({ byDistance[i].second, distance });
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "Exam_HelperStructs.h"
+
+namespace Elite
+{
+	class NavMesh;
+
+	// Travel distance between every pair of known places (house centers and wander points).
+	// Nodes are linked to their closest neighbors with the nav mesh distance estimate, the table holds the shortest
+	// distance over those links. Adding a node updates the table in O(n^2) instead of recomputing it, lookups are O(1).
+	class DistanceTable final
+	{
+	public:
+		static constexpr float Unreachable{ FLT_MAX };
+
+		void SetNavMesh(const NavMesh* pNavMesh) { m_pNavMesh = pNavMesh; }
+
+		// Returns the index of the node, an existing one when there is a node at the position already
+		int AddNode(const Vector2& position);
+		// -1 when there is no node at the position
+		int FindNode(const Vector2& position) const;
+
+		int GetNodeCount() const { return static_cast<int>(m_Nodes.size()); }
+		const Vector2& GetNode(int index) const { return m_Nodes[index]; }
+
+		float GetDistance(int from, int to) const { return m_Distances[from * m_Capacity + to]; }
+		// Closest of the candidates seen from the node, -1 when none of them can be reached
+		int FindClosest(int from, const std::vector<int>& candidates) const;
+
+	private:
+		float& Distance(int from, int to) { return m_Distances[from * m_Capacity + to]; }
+		void Reserve(int nodeCount);
+		void GetLinks(const Vector2& position, std::vector<std::pair<int, float>>& links) const;
+
+		// Nodes closer than this are always linked, the closest MinLinkCount ones are linked at any distance
+		float m_LinkRange{ 80.f };
+		static constexpr int MinLinkCount{ 3 };
+
+		const NavMesh* m_pNavMesh{ nullptr };
+		std::vector<Vector2> m_Nodes{};
+		// Row major, m_Capacity floats per row so adding a node doesn't move the rows
+		std::vector<float> m_Distances{};
+		int m_Capacity{};
+	};
+}
@@ -0,0 +1,157 @@
+#include "stdafx.h"
+#include "LineOfSight.h"
+
+using namespace Elite;
+
+void LineOfSight::Initialize(const WorldInfo& worldInfo)
+{
+	m_GridOrigin = worldInfo.Center - worldInfo.Dimensions / 2.f;
+	m_GridColumns = max(1, static_cast<int>(ceilf(worldInfo.Dimensions.x / m_CellSize)));
+	m_GridRows = max(1, static_cast<int>(ceilf(worldInfo.Dimensions.y / m_CellSize)));
+	m_Cells.assign(m_GridColumns * m_GridRows, WallCell{});
+	m_IsInitialized = true;
+
+	//Houses can be seen before the world info is known
+	for (const HouseInfo& house : m_Houses)
+		AddWalls(house);
+}
+
+bool LineOfSight::AddHouse(const HouseInfo& houseInfo)
+{
+	constexpr float delta{ 1.f };
+	for (const HouseInfo& house : m_Houses)
+	{
+		if (DistanceSquared(house.Center, houseInfo.Center) <= delta)
+			return false;
+	}
+
+	m_Houses.push_back(houseInfo);
+	if (m_IsInitialized)
+		AddWalls(houseInfo);
+	return true;
+}
+
+bool LineOfSight::IsBlocked(const Vector2& from, const Vector2& to) const
+{
+	if (m_Cells.empty())
+		return false;
+
+	//A zero direction makes the slab test divide 0 by 0, a tiny one keeps it on the right side of the slab
+	constexpr float tiny{ 1e-30f };
+	Vector2 direction{ to - from };
+	if (direction.x == 0.f)
+		direction.x = tiny;
+	if (direction.y == 0.f)
+		direction.y = tiny;
+	const Vector2 inverseDirection{ 1.f / direction.x, 1.f / direction.y };
+
+	//Clip the segment to the grid, there are no walls outside of it
+	const Vector2 gridMax{ m_GridOrigin.x + m_GridColumns * m_CellSize, m_GridOrigin.y + m_GridRows * m_CellSize };
+	const float tx1{ (m_GridOrigin.x - from.x) * inverseDirection.x };
+	const float tx2{ (gridMax.x - from.x) * inverseDirection.x };
+	const float ty1{ (m_GridOrigin.y - from.y) * inverseDirection.y };
+	const float ty2{ (gridMax.y - from.y) * inverseDirection.y };
+	const float tEnter{ max(0.f, max(min(tx1, tx2), min(ty1, ty2))) };
+	const float tExit{ min(1.f, min(max(tx1, tx2), max(ty1, ty2))) };
+	if (tEnter > tExit)
+		return false;
+
+	//Walk the cells the segment passes through (Amanatides & Woo)
+	const Vector2 start{ from + direction * tEnter };
+	const Vector2 end{ from + direction * tExit };
+	int column = Clamp(static_cast<int>((start.x - m_GridOrigin.x) / m_CellSize), 0, m_GridColumns - 1);
+	int row = Clamp(static_cast<int>((start.y - m_GridOrigin.y) / m_CellSize), 0, m_GridRows - 1);
+	const int endColumn = Clamp(static_cast<int>((end.x - m_GridOrigin.x) / m_CellSize), 0, m_GridColumns - 1);
+	const int endRow = Clamp(static_cast<int>((end.y - m_GridOrigin.y) / m_CellSize), 0, m_GridRows - 1);
+
+	const int stepColumn{ direction.x > 0.f ? 1 : -1 };
+	const int stepRow{ direction.y > 0.f ? 1 : -1 };
+	const float nextColumnX{ m_GridOrigin.x + (column + (stepColumn > 0 ? 1 : 0)) * m_CellSize };
+	const float nextRowY{ m_GridOrigin.y + (row + (stepRow > 0 ? 1 : 0)) * m_CellSize };
+	float tNextColumn{ (nextColumnX - from.x) * inverseDirection.x };
+	float tNextRow{ (nextRowY - from.y) * inverseDirection.y };
+	const float tDeltaColumn{ m_CellSize * fabsf(inverseDirection.x) };
+	const float tDeltaRow{ m_CellSize * fabsf(inverseDirection.y) };
+
+	const int maxSteps{ m_GridColumns + m_GridRows };
+	for (int step = 0; step <= maxSteps; ++step)
+	{
+		if (IsCellBlocking(m_Cells[row * m_GridColumns + column], from, inverseDirection))
+			return true;
+		if (column == endColumn && row == endRow)
+			break;
+
+		if (tNextColumn < tNextRow)
+		{
+			column += stepColumn;
+			tNextColumn += tDeltaColumn;
+		}
+		else
+		{
+			row += stepRow;
+			tNextRow += tDeltaRow;
+		}
+		if (column < 0 || column >= m_GridColumns || row < 0 || row >= m_GridRows)
+			break;
+	}
+	return false;
+}
+
+void LineOfSight::AreBlocked(const Vector2& from, const std::vector<Vector2>& targets, std::vector<uint8_t>& results) const
+{
+	results.resize(targets.size());
+	for (size_t i = 0; i < targets.size(); ++i)
+		results[i] = IsBlocked(from, targets[i]);
+}
+
+void LineOfSight::AreBlocked(const SegmentArrays& segments, std::vector<uint8_t>& results) const
+{
+	results.resize(segments.GetSize());
+	for (size_t i = 0; i < segments.GetSize(); ++i)
+		results[i] = IsBlocked({ segments.startX[i], segments.startY[i] }, { segments.endX[i], segments.endY[i] });
+}
+
+void LineOfSight::AddWalls(const HouseInfo& houseInfo)
+{
+	const Vector2 halfSize{ houseInfo.Size / 2.f };
+	const Vector2 houseMin{ houseInfo.Center - halfSize };
+	const Vector2 houseMax{ houseInfo.Center + halfSize };
+	const float t{ m_WallHalfThickness };
+
+	//We don't know where the doors are, so all 4 walls are closed. A line that starts or ends in a wall box
+	//(standing in the doorway) isn't blocked by that box, see IsCellBlocking
+	AddWall({ houseMin.x - t, houseMin.y - t }, { houseMax.x + t, houseMin.y + t });
+	AddWall({ houseMin.x - t, houseMax.y - t }, { houseMax.x + t, houseMax.y + t });
+	AddWall({ houseMin.x - t, houseMin.y - t }, { houseMin.x + t, houseMax.y + t });
+	AddWall({ houseMax.x - t, houseMin.y - t }, { houseMax.x + t, houseMax.y + t });
+}
+
+void LineOfSight::AddWall(const Vector2& wallMin, const Vector2& wallMax)
+{
+	const int minColumn = Clamp(static_cast<int>((wallMin.x - m_GridOrigin.x) / m_CellSize), 0, m_GridColumns - 1);
+	const int maxColumn = Clamp(static_cast<int>((wallMax.x - m_GridOrigin.x) / m_CellSize), 0, m_GridColumns - 1);
+	const int minRow = Clamp(static_cast<int>((wallMin.y - m_GridOrigin.y) / m_CellSize), 0, m_GridRows - 1);
+	const int maxRow = Clamp(static_cast<int>((wallMax.y - m_GridOrigin.y) / m_CellSize), 0, m_GridRows - 1);
+
+	for (int row = minRow; row <= maxRow; ++row)
+	{
+		for (int column = minColumn; column <= maxColumn; ++column)
+		{
+			WallCell& cell = m_Cells[row * m_GridColumns + column];
+			cell.minX.push_back(wallMin.x);
+			cell.minY.push_back(wallMin.y);
+			cell.maxX.push_back(wallMax.x);
+			cell.maxY.push_back(wallMax.y);
+		}
+	}
+}
+
+bool LineOfSight::IsCellBlocking(const WallCell& cell, const Vector2& from, const Vector2& inverseDirection) const
+{
+	//Slab test of the segment from + t * direction, t in [0, 1] against every wall box in the cell,
+	//boxes that hold one of the ends are skipped so a doorway doesn't block everything
+	if (cell.minX.empty())
+		return false;
+	const BoxSoA boxes{ cell.minX.data(), cell.minY.data(), cell.maxX.data(), cell.maxY.data() };
+	return Simd::SegmentAnyBox(from, inverseDirection, boxes, cell.minX.size());
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "Exam_HelperStructs.h"
+#include "EliteGeometry/EGeometry2DTypes.h"
+
+namespace Elite
+{
+	// Walls of the houses we have seen so far, to know if a shot or an item is behind a wall.
+	// The walls are thin boxes, stored per grid cell as structure of arrays so they can be tested a pack at a time.
+	// A wall box that holds one of the ends of the line doesn't block it, the agent or target is in a doorway.
+	class LineOfSight final
+	{
+	public:
+		void Initialize(const WorldInfo& worldInfo);
+		bool IsInitialized() const { return m_IsInitialized; }
+
+		// returns true if the house was not known yet
+		bool AddHouse(const HouseInfo& houseInfo);
+
+		bool IsBlocked(const Vector2& from, const Vector2& to) const;
+		// results[i] is 1 when the line from -> targets[i] is blocked
+		void AreBlocked(const Vector2& from, const std::vector<Vector2>& targets, std::vector<uint8_t>& results) const;
+		// results[i] is 1 when segment i is blocked
+		void AreBlocked(const SegmentArrays& segments, std::vector<uint8_t>& results) const;
+
+	private:
+		struct WallCell
+		{
+			std::vector<float> minX{};
+			std::vector<float> minY{};
+			std::vector<float> maxX{};
+			std::vector<float> maxY{};
+		};
+
+		void AddWalls(const HouseInfo& houseInfo);
+		void AddWall(const Vector2& wallMin, const Vector2& wallMax);
+		bool IsCellBlocking(const WallCell& cell, const Vector2& from, const Vector2& inverseDirection) const;
+
+		// Uniform grid over the world, a wall is in every cell its box overlaps
+		std::vector<WallCell> m_Cells{};
+		Vector2 m_GridOrigin{};
+		int m_GridColumns{};
+		int m_GridRows{};
+		float m_CellSize{ 16.f };
+		float m_WallHalfThickness{ 0.25f };
+
+		std::vector<HouseInfo> m_Houses{};
+		bool m_IsInitialized = false;
+	};
+}
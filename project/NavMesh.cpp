@@ -0,0 +1,951 @@
+#include "stdafx.h"
+#include "NavMesh.h"
+
+using namespace Elite;
+
+namespace
+{
+	Vector2 ClosestPointOnTriangle(const Vector2& point, const Vector2& p1, const Vector2& p2, const Vector2& p3)
+	{
+		if (PointInTriangle(point, p1, p2, p3, true))
+			return point;
+
+		//Closest point is on one of the edges
+		const Vector2 edgePoints[3]{ ProjectOnLineSegment(p1, p2, point), ProjectOnLineSegment(p2, p3, point), ProjectOnLineSegment(p3, p1, point) };
+		Vector2 closest{ edgePoints[0] };
+		for (int i = 1; i < 3; ++i)
+		{
+			if (DistanceSquared(point, edgePoints[i]) < DistanceSquared(point, closest))
+				closest = edgePoints[i];
+		}
+		return closest;
+	}
+
+	struct ClipVertex
+	{
+		Vector2 point{};
+		int edgeMask{}; //bit i is set when the point lies on triangle edge i (points[i], points[i+1])
+	};
+
+	constexpr int GetVertexMask(int vertex)
+	{
+		return (1 << vertex) | (1 << ((vertex + 2) % 3));
+	}
+
+	float GetArea(const std::vector<ClipVertex>& shape)
+	{
+		float doubleArea{};
+		for (size_t i = 0; i < shape.size(); ++i)
+			doubleArea += Cross(shape[i].point, shape[(i + 1) % shape.size()].point);
+		return doubleArea / 2.f;
+	}
+
+	//Crossing of a clip line with the edge (current, next).
+	//When both points are on the same triangle edge the crossing is computed from the end points of that edge in a fixed order,
+	//so the triangle on the other side of the edge gets exactly the same point and the cut mesh has no T-junctions
+	ClipVertex GetCrossing(const std::array<Vector2, 3>& triangle, const ClipVertex& current, const ClipVertex& next,
+		const Vector2& lineStart, const Vector2& lineDirection)
+	{
+		const int sharedEdges{ current.edgeMask & next.edgeMask };
+		if (sharedEdges != 0)
+		{
+			const int edge{ (sharedEdges & 1) ? 0 : ((sharedEdges & 2) ? 1 : 2) };
+			int first{ edge };
+			int second{ (edge + 1) % 3 };
+			const Vector2& p1 = triangle[first];
+			const Vector2& p2 = triangle[second];
+			if (p2.x < p1.x || (p2.x == p1.x && p2.y < p1.y))
+				std::swap(first, second);
+
+			const Vector2& a = triangle[first];
+			const Vector2& b = triangle[second];
+			const float sideA{ Cross(lineDirection, a - lineStart) };
+			const float sideB{ Cross(lineDirection, b - lineStart) };
+			if (sideA != sideB)
+			{
+				//Crossings close to a corner snap to it, slivers only make the ear clipping fail
+				constexpr float snapDistance{ 0.01f };
+				const float t{ Clamp(sideA / (sideA - sideB), 0.f, 1.f) };
+				const float length{ Distance(a, b) };
+				if (t * length <= snapDistance)
+					return { a, GetVertexMask(first) };
+				if ((1.f - t) * length <= snapDistance)
+					return { b, GetVertexMask(second) };
+				return { a + (b - a) * t, 1 << edge };
+			}
+		}
+
+		const float sideCurrent{ Cross(lineDirection, current.point - lineStart) };
+		const float sideNext{ Cross(lineDirection, next.point - lineStart) };
+		const float t{ sideCurrent / (sideCurrent - sideNext) };
+		return { current.point + (next.point - current.point) * t, 0 };
+	}
+
+	//Sutherland-Hodgman clip of a CCW triangle with a convex CCW shape
+	void ClipTriangle(const std::array<Vector2, 3>& triangle, const std::vector<Vector2>& clipShape, std::vector<ClipVertex>& result)
+	{
+		result = { { triangle[0], GetVertexMask(0) }, { triangle[1], GetVertexMask(1) }, { triangle[2], GetVertexMask(2) } };
+		std::vector<ClipVertex> input{};
+		for (size_t i = 0; i < clipShape.size() && result.size() >= 3; ++i)
+		{
+			const Vector2& lineStart = clipShape[i];
+			const Vector2 lineDirection{ clipShape[(i + 1) % clipShape.size()] - lineStart };
+
+			input.swap(result);
+			result.clear();
+			for (size_t j = 0; j < input.size(); ++j)
+			{
+				const ClipVertex& current = input[j];
+				const ClipVertex& next = input[(j + 1) % input.size()];
+				const bool isCurrentInside{ Cross(lineDirection, current.point - lineStart) >= 0.f };
+				const bool isNextInside{ Cross(lineDirection, next.point - lineStart) >= 0.f };
+				if (isCurrentInside)
+					result.push_back(current);
+				if (isCurrentInside != isNextInside)
+					result.push_back(GetCrossing(triangle, current, next, lineStart, lineDirection));
+			}
+
+			//Snapped crossings can land on a point that is already there
+			for (size_t j = 0; j < result.size() && result.size() > 1;)
+			{
+				ClipVertex& next = result[(j + 1) % result.size()];
+				if (result[j].point == next.point)
+				{
+					next.edgeMask |= result[j].edgeMask;
+					result.erase(result.begin() + j);
+				}
+				else
+					++j;
+			}
+		}
+	}
+
+	//Position of a point on the triangle border, vertex i is at i and the points on edge i are between i and i + 1
+	float GetBorderPosition(const std::array<Vector2, 3>& triangle, const ClipVertex& vertex)
+	{
+		for (int i = 0; i < 3; ++i)
+		{
+			if (vertex.edgeMask == GetVertexMask(i))
+				return static_cast<float>(i);
+		}
+
+		const int edge{ (vertex.edgeMask & 1) ? 0 : ((vertex.edgeMask & 2) ? 1 : 2) };
+		const Vector2 edgeVector{ triangle[(edge + 1) % 3] - triangle[edge] };
+		const float t{ Dot(vertex.point - triangle[edge], edgeVector) / edgeVector.MagnitudeSquared() };
+		return edge + Clamp(t, 0.f, 1.f);
+	}
+
+	//Triangulates what is left of a CCW triangle after cutting out the convex part cut
+	void TriangulateRemainder(const std::array<Vector2, 3>& triangle, const std::vector<ClipVertex>& cut, std::vector<std::array<Vector2, 3>>& result)
+	{
+		constexpr float minArea{ 0.001f };
+		const float triangleArea{ Cross(triangle[1] - triangle[0], triangle[2] - triangle[0]) / 2.f };
+		if (GetArea(cut) >= triangleArea - minArea)
+			return;
+
+		const auto addPiece = [&result](Polygon& piece)
+		{
+			piece.Triangulate();
+			for (const Triangle* pTriangle : piece.GetTriangles())
+				result.push_back({ { pTriangle->p1, pTriangle->p2, pTriangle->p3 } });
+		};
+
+		const int cutSize{ static_cast<int>(cut.size()) };
+		const auto borderIt = std::find_if(cut.begin(), cut.end(), [](const ClipVertex& vertex) { return vertex.edgeMask != 0; });
+		if (borderIt == cut.end())
+		{
+			//The cut is inside the triangle, it becomes a hole
+			std::vector<Vector2> holePoints{};
+			for (auto it = cut.rbegin(); it != cut.rend(); ++it)
+				holePoints.push_back(it->point);
+			Polygon piece{ std::vector<Vector2>{ triangle.begin(), triangle.end() } };
+			piece.AddChild(Polygon{ holePoints });
+			addPiece(piece);
+			return;
+		}
+
+		//Every chain of cut edges running through the inside of the triangle, from border point A to border point B,
+		//splits off a piece: the chain backwards from B to A and then the triangle border from A to B
+		std::vector<Vector2> piecePoints{};
+		for (int start = 0; start < cutSize; ++start)
+		{
+			if (cut[start].edgeMask == 0)
+				continue;
+
+			int end{ (start + 1) % cutSize };
+			while (cut[end].edgeMask == 0)
+				end = (end + 1) % cutSize;
+			if (end == (start + 1) % cutSize && (cut[start].edgeMask & cut[end].edgeMask) != 0)
+				continue; //edge along the triangle border
+
+			piecePoints.clear();
+			for (int i = end; i != start; i = (i + cutSize - 1) % cutSize)
+				piecePoints.push_back(cut[i].point);
+			if (start != end)
+				piecePoints.push_back(cut[start].point);
+
+			const float startPosition{ GetBorderPosition(triangle, cut[start]) };
+			float endPosition{ GetBorderPosition(triangle, cut[end]) };
+			if (endPosition <= startPosition)
+				endPosition += 3.f;
+			for (int vertex = static_cast<int>(startPosition) + 1; vertex < endPosition; ++vertex)
+				piecePoints.push_back(triangle[vertex % 3]);
+
+			if (piecePoints.size() < 3)
+				continue;
+			Polygon piece{ piecePoints };
+			addPiece(piece);
+		}
+	}
+}
+
+NavMesh::~NavMesh()
+{
+	//The mesh is settled now, the file is only written here so the game never waits on it
+	if (!m_CacheFilePath.empty())
+		m_TriangulationCache.Save(m_CacheFilePath);
+	SAFE_DELETE(m_pPolygon);
+}
+
+void NavMesh::Initialize(const WorldInfo& worldInfo, float agentRadius)
+{
+	m_WorldMin = worldInfo.Center - worldInfo.Dimensions / 2.f;
+	m_WorldMax = worldInfo.Center + worldInfo.Dimensions / 2.f;
+	m_AgentRadius = agentRadius;
+	if (!m_CacheFilePath.empty())
+		m_TriangulationCache.Load(m_CacheFilePath);
+	m_IsInitialized = true;
+	m_IsDirty = true;
+}
+
+bool NavMesh::AddHouse(const HouseInfo& houseInfo)
+{
+	constexpr float delta{ 1.f };
+	for (const HouseInfo& house : m_Houses)
+	{
+		if (DistanceSquared(house.Center, houseInfo.Center) <= delta)
+			return false;
+	}
+
+	m_Houses.push_back(houseInfo);
+	m_IsDirty = true;
+	return true;
+}
+
+void NavMesh::Update()
+{
+	if (m_IsInitialized && m_IsDirty)
+		Rebuild();
+}
+
+bool NavMesh::FindPath(const Vector2& start, const Vector2& goal, std::vector<Vector2>& path, float& pathCost) const
+{
+	std::vector<int> corridor{};
+	return FindPath(start, goal, path, pathCost, corridor);
+}
+
+bool NavMesh::FindPath(const Vector2& start, const Vector2& goal, std::vector<Vector2>& path, float& pathCost, std::vector<int>& corridor) const
+{
+	path.clear();
+	pathCost = 0.f;
+	if (m_Triangles.empty())
+		return false;
+
+	//Start and goal are allowed to be a bit outside of the mesh (e.g. agent hugging a wall, item next to a wall)
+	const float snapDistance{ 2.f * m_AgentRadius };
+	Vector2 snappedStart{ start };
+	Vector2 snappedGoal{ goal };
+	int startTriangle = GetTriangleIndex(start);
+	if (startTriangle == -1)
+		startTriangle = FindNearestTriangle(start, snapDistance, snappedStart);
+	int goalTriangle = GetTriangleIndex(goal);
+	if (goalTriangle == -1)
+		goalTriangle = FindNearestTriangle(goal, snapDistance, snappedGoal);
+	if (startTriangle == -1 || goalTriangle == -1)
+		return false;
+
+	float corridorCost{};
+	if (!FindCorridor(startTriangle, goalTriangle, snappedGoal, corridor, corridorCost))
+		return false;
+
+	StringPull(snappedStart, snappedGoal, corridor, path);
+	if (snappedStart != start)
+		path.insert(path.begin(), start);
+	if (snappedGoal != goal)
+		path.push_back(goal);
+
+	for (size_t i = 1; i < path.size(); ++i)
+		pathCost += Distance(path[i - 1], path[i]);
+	return true;
+}
+
+float NavMesh::EstimateDistance(const Vector2& start, const Vector2& goal) const
+{
+	const float directDistance{ Distance(start, goal) };
+	if (m_Triangles.empty())
+		return directDistance;
+
+	Vector2 snapped{};
+	int startTriangle = GetTriangleIndex(start);
+	if (startTriangle == -1)
+		startTriangle = FindNearestTriangle(start, FLT_MAX, snapped);
+	int goalTriangle = GetTriangleIndex(goal);
+	if (goalTriangle == -1)
+		goalTriangle = FindNearestTriangle(goal, FLT_MAX, snapped);
+	if (startTriangle == -1 || goalTriangle == -1 || startTriangle == goalTriangle)
+		return directDistance;
+
+	//The corridor cost only depends on the triangles, so it can be shared by all positions inside them
+	const uint64_t key{ (static_cast<uint64_t>(startTriangle) << 32) | static_cast<uint32_t>(goalTriangle) };
+	auto it = m_CostCache.find(key);
+	if (it == m_CostCache.end())
+	{
+		std::vector<int> corridor{};
+		float cost{};
+		if (!FindCorridor(startTriangle, goalTriangle, m_Triangles[goalTriangle].center, corridor, cost))
+			cost = FLT_MAX;
+		it = m_CostCache.emplace(key, cost).first;
+	}
+	return max(directDistance, it->second);
+}
+
+bool NavMesh::GetNextPathPoint(const Vector2& agentPos, const Vector2& goal, Vector2& nextPoint)
+{
+	if (m_Triangles.empty())
+		return false;
+
+	constexpr float goalTolerance{ 1.f };
+	const bool isSameGoal{ DistanceSquared(goal, m_CurrentGoal) <= Square(goalTolerance) };
+
+	//Off mesh (e.g. in the wall margin) is not straying, only being in a triangle outside of the corridor is
+	const int agentTriangle = GetTriangleIndex(agentPos);
+	const bool hasStrayed{ agentTriangle != -1 &&
+		std::find(m_CurrentCorridor.begin(), m_CurrentCorridor.end(), agentTriangle) == m_CurrentCorridor.end() };
+
+	if (!isSameGoal || hasStrayed || m_CurrentPath.empty())
+	{
+		float cost{};
+		if (!FindPath(agentPos, goal, m_CurrentPath, cost, m_CurrentCorridor))
+		{
+			m_CurrentPath.clear();
+			m_CurrentCorridor.clear();
+			return false;
+		}
+
+		m_CurrentGoal = goal;
+		m_CurrentPathIndex = 1;
+	}
+
+	//Skip the points we already reached
+	while (m_CurrentPathIndex + 1 < m_CurrentPath.size()
+		&& DistanceSquared(agentPos, m_CurrentPath[m_CurrentPathIndex]) <= Square(m_AgentRadius))
+	{
+		++m_CurrentPathIndex;
+	}
+
+	nextPoint = m_CurrentPath[min(m_CurrentPathIndex, m_CurrentPath.size() - 1)];
+	return true;
+}
+
+int NavMesh::AddObstacle(const Vector2& center, float radius)
+{
+	const Obstacle obstacle{ m_NextObstacleId++, center, radius };
+	m_Obstacles.push_back(obstacle);
+	m_Edits.emplace_back();
+
+	//A dirty mesh cuts all obstacles when it gets rebuilt
+	if (!m_IsDirty)
+		CutObstacle(obstacle, m_Edits.back());
+	ClearPathCache();
+	return obstacle.id;
+}
+
+void NavMesh::RemoveObstacle(int obstacleId)
+{
+	const auto it = std::find_if(m_Obstacles.begin(), m_Obstacles.end(), [obstacleId](const Obstacle& obstacle) { return obstacle.id == obstacleId; });
+	if (it == m_Obstacles.end())
+		return;
+
+	const size_t index = it - m_Obstacles.begin();
+
+	//A dirty mesh cuts all obstacles when it gets rebuilt, its edits don't match the triangles
+	if (m_IsDirty)
+	{
+		m_Obstacles.erase(it);
+		m_Edits.erase(m_Edits.begin() + index);
+		ClearPathCache();
+		return;
+	}
+
+	//Edits can only be undone last to first, the obstacles cut after this one get cut again
+	for (size_t i = m_Edits.size(); i > index; --i)
+		UndoEdit(m_Edits[i - 1]);
+
+	m_Obstacles.erase(it);
+	m_Edits.resize(index);
+	for (size_t i = index; i < m_Obstacles.size(); ++i)
+	{
+		m_Edits.emplace_back();
+		CutObstacle(m_Obstacles[i], m_Edits.back());
+	}
+	ClearPathCache();
+}
+
+int NavMesh::GetTriangleIndex(const Vector2& position) const
+{
+	const int cell = GetCellIndex(position);
+	if (cell == -1)
+		return -1;
+
+	for (const int index : m_Grid[cell])
+	{
+		const NavTriangle& triangle = m_Triangles[index];
+		if (!triangle.isRemoved && PointInTriangle(position, triangle.points[0], triangle.points[1], triangle.points[2], true))
+			return index;
+	}
+	return -1;
+}
+
+void NavMesh::Rebuild()
+{
+	m_IsDirty = false;
+	SAFE_DELETE(m_pPolygon);
+	m_Triangles.clear();
+	m_Grid.clear();
+	ClearPathCache();
+
+	//Outer shape is the world border (CCW)
+	const std::vector<Vector2> outerShape{ m_WorldMin, { m_WorldMax.x, m_WorldMin.y }, m_WorldMax, { m_WorldMin.x, m_WorldMax.y } };
+	m_pPolygon = new Polygon(outerShape);
+
+	//Houses are the holes (CW), expanded by the agent radius so the paths keep their distance from the walls
+	constexpr float borderMargin{ 0.1f };
+	for (const HouseInfo& house : m_Houses)
+	{
+		const Vector2 halfSize{ house.Size / 2.f };
+		const Vector2 houseMin{ house.Center - halfSize };
+		const Vector2 houseMax{ house.Center + halfSize };
+		Polygon hole{ std::vector<Vector2>{ houseMin, { houseMin.x, houseMax.y }, houseMax, { houseMax.x, houseMin.y } } };
+		hole.ExpandShape(m_AgentRadius);
+
+		std::vector<Vector2> holePoints{ hole.GetPoints().begin(), hole.GetPoints().end() };
+		for (Vector2& point : holePoints)
+		{
+			point.x = Clamp(point.x, m_WorldMin.x + borderMargin, m_WorldMax.x - borderMargin);
+			point.y = Clamp(point.y, m_WorldMin.y + borderMargin, m_WorldMax.y - borderMargin);
+		}
+
+		if (holePoints[2].x <= holePoints[0].x || holePoints[2].y <= holePoints[0].y)
+			continue;
+
+		//Overlapping holes get merged by Triangulate
+		m_pPolygon->AddChild(Polygon{ holePoints });
+	}
+
+	//Merged outlines can carry vertices that don't add anything, a few cm off is fine for the agent
+	constexpr float simplifyTolerance{ 0.05f };
+	//Same triangle count as plain ear clipping but no slivers, which keeps the point in triangle tests and the path costs sane
+	constexpr TriangulationMode triangulationMode{ TriangulationMode::ConstrainedDelaunay };
+
+	//Every run of the same level sees the same sets of houses, so the triangulations are cached on disk.
+	//The key also covers the settings, a triangulation made with other settings can't be reused.
+	//The tolerance goes in as its bits, std::hash<float> isn't the same for every standard library
+	uint32_t toleranceBits{};
+	memcpy(&toleranceBits, &simplifyTolerance, sizeof(toleranceBits));
+	const uint64_t cacheKey{ m_pPolygon->GetContentHash() * 31 + static_cast<uint64_t>(toleranceBits) * 2 + static_cast<uint64_t>(triangulationMode) };
+	const bool useCache{ !m_CacheFilePath.empty() };
+	if (!useCache || !m_pPolygon->ReadTriangulationCache(m_TriangulationCache, cacheKey))
+	{
+		m_pPolygon->Triangulate(triangulationMode, simplifyTolerance, &m_WorkerPool);
+		if (useCache)
+			m_pPolygon->WriteTriangulationCache(m_TriangulationCache, cacheKey);
+	}
+	BuildGraph();
+	BuildGrid();
+
+	//The obstacles outlive the mesh, cut them out of the new one
+	m_Edits.assign(m_Obstacles.size(), MeshEdit{});
+	for (size_t i = 0; i < m_Obstacles.size(); ++i)
+		CutObstacle(m_Obstacles[i], m_Edits[i]);
+}
+
+void NavMesh::BuildGraph()
+{
+	const std::vector<Triangle*>& triangles = m_pPolygon->GetTriangles();
+	const std::vector<Line*>& lines = m_pPolygon->GetLines();
+
+	//Two triangles are neighbors when they share a line of the line matrix
+	std::vector<int> lineOwners(lines.size(), -1);
+	m_Triangles.resize(triangles.size());
+	for (int i = 0; i < static_cast<int>(triangles.size()); ++i)
+	{
+		const Triangle* pTriangle = triangles[i];
+		NavTriangle& navTriangle = m_Triangles[i];
+		navTriangle.points = { { pTriangle->p1, pTriangle->p2, pTriangle->p3 } };
+		navTriangle.center = pTriangle->GetCenter();
+
+		for (int edge = 0; edge < 3; ++edge)
+		{
+			const int lineIndex = pTriangle->metaData.IndexLines[edge];
+			if (lineIndex < 0)
+				continue;
+
+			const int other = lineOwners[lineIndex];
+			if (other == -1)
+			{
+				lineOwners[lineIndex] = i;
+				continue;
+			}
+
+			navTriangle.neighbors[edge] = other;
+			for (int otherEdge = 0; otherEdge < 3; ++otherEdge)
+			{
+				if (triangles[other]->metaData.IndexLines[otherEdge] == lineIndex)
+					m_Triangles[other].neighbors[otherEdge] = i;
+			}
+		}
+	}
+}
+
+void NavMesh::BuildGrid()
+{
+	m_GridOrigin = m_WorldMin;
+	m_GridColumns = max(1, static_cast<int>(ceilf((m_WorldMax.x - m_WorldMin.x) / m_CellSize)));
+	m_GridRows = max(1, static_cast<int>(ceilf((m_WorldMax.y - m_WorldMin.y) / m_CellSize)));
+	m_Grid.assign(m_GridColumns * m_GridRows, std::vector<int>{});
+
+	for (int i = 0; i < static_cast<int>(m_Triangles.size()); ++i)
+		AddToGrid(i);
+}
+
+void NavMesh::AddToGrid(int triangleIndex, std::vector<int>* pAddedCells)
+{
+	//A triangle goes in all the cells its bounding box overlaps
+	const auto& points = m_Triangles[triangleIndex].points;
+	const float minX = min(points[0].x, min(points[1].x, points[2].x));
+	const float maxX = max(points[0].x, max(points[1].x, points[2].x));
+	const float minY = min(points[0].y, min(points[1].y, points[2].y));
+	const float maxY = max(points[0].y, max(points[1].y, points[2].y));
+
+	const int minColumn = Clamp(static_cast<int>((minX - m_GridOrigin.x) / m_CellSize), 0, m_GridColumns - 1);
+	const int maxColumn = Clamp(static_cast<int>((maxX - m_GridOrigin.x) / m_CellSize), 0, m_GridColumns - 1);
+	const int minRow = Clamp(static_cast<int>((minY - m_GridOrigin.y) / m_CellSize), 0, m_GridRows - 1);
+	const int maxRow = Clamp(static_cast<int>((maxY - m_GridOrigin.y) / m_CellSize), 0, m_GridRows - 1);
+
+	for (int row = minRow; row <= maxRow; ++row)
+	{
+		for (int column = minColumn; column <= maxColumn; ++column)
+		{
+			const int cell{ row * m_GridColumns + column };
+			m_Grid[cell].push_back(triangleIndex);
+			if (pAddedCells)
+				pAddedCells->push_back(cell);
+		}
+	}
+}
+
+void NavMesh::CutObstacle(const Obstacle& obstacle, MeshEdit& edit)
+{
+	edit = MeshEdit{};
+	edit.triangleCount = m_Triangles.size();
+	if (m_Grid.empty())
+		return;
+
+	//Polygon around the circle expanded by the agent radius, its edges touch the circle so the whole circle is inside it
+	constexpr int segmentCount{ 16 };
+	const float radius{ (obstacle.radius + m_AgentRadius) / cosf(static_cast<float>(E_PI) / segmentCount) };
+	std::vector<Vector2> shape(segmentCount);
+	for (int i = 0; i < segmentCount; ++i)
+	{
+		const float angle{ i * 2.f * static_cast<float>(E_PI) / segmentCount };
+		shape[i] = obstacle.center + Vector2{ cosf(angle), sinf(angle) } * radius;
+	}
+
+	//Only the triangles in the cells around the obstacle can be hit
+	std::vector<int> candidates{};
+	const int minColumn = Clamp(static_cast<int>((obstacle.center.x - radius - m_GridOrigin.x) / m_CellSize), 0, m_GridColumns - 1);
+	const int maxColumn = Clamp(static_cast<int>((obstacle.center.x + radius - m_GridOrigin.x) / m_CellSize), 0, m_GridColumns - 1);
+	const int minRow = Clamp(static_cast<int>((obstacle.center.y - radius - m_GridOrigin.y) / m_CellSize), 0, m_GridRows - 1);
+	const int maxRow = Clamp(static_cast<int>((obstacle.center.y + radius - m_GridOrigin.y) / m_CellSize), 0, m_GridRows - 1);
+	for (int row = minRow; row <= maxRow; ++row)
+	{
+		for (int column = minColumn; column <= maxColumn; ++column)
+		{
+			const std::vector<int>& cell = m_Grid[row * m_GridColumns + column];
+			candidates.insert(candidates.end(), cell.begin(), cell.end());
+		}
+	}
+	std::sort(candidates.begin(), candidates.end());
+	candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+	constexpr float minCutArea{ 0.001f };
+	std::vector<int> cutTriangles{};
+	std::vector<std::array<Vector2, 3>> cutTrianglePoints{};
+	std::vector<std::vector<ClipVertex>> cuts{};
+	std::vector<ClipVertex> cut{};
+	for (const int index : candidates)
+	{
+		const NavTriangle& triangle = m_Triangles[index];
+		if (triangle.isRemoved)
+			continue;
+
+		std::array<Vector2, 3> points{ triangle.points };
+		if (Cross(points[1] - points[0], points[2] - points[0]) < 0.f)
+			std::swap(points[1], points[2]);
+
+		ClipTriangle(points, shape, cut);
+		if (cut.size() < 3 || GetArea(cut) <= minCutArea)
+			continue;
+
+		cutTriangles.push_back(index);
+		cutTrianglePoints.push_back(points);
+		cuts.push_back(cut);
+	}
+	if (cutTriangles.empty())
+		return;
+
+	//The triangles around the cut area lose their links into it, they get linked again to the new triangles below
+	std::vector<int> borderTriangles{};
+	for (const int index : cutTriangles)
+	{
+		for (const int neighbor : m_Triangles[index].neighbors)
+		{
+			if (neighbor != -1 && !std::binary_search(cutTriangles.begin(), cutTriangles.end(), neighbor))
+				borderTriangles.push_back(neighbor);
+		}
+	}
+	std::sort(borderTriangles.begin(), borderTriangles.end());
+	borderTriangles.erase(std::unique(borderTriangles.begin(), borderTriangles.end()), borderTriangles.end());
+	for (const int index : borderTriangles)
+	{
+		edit.oldTriangles.push_back({ index, m_Triangles[index] });
+		for (int& neighbor : m_Triangles[index].neighbors)
+		{
+			if (std::binary_search(cutTriangles.begin(), cutTriangles.end(), neighbor))
+				neighbor = -1;
+		}
+	}
+
+	//The pieces of a triangle reuse its slot, so the indices of the rest of the mesh stay valid
+	std::vector<int> newTriangles{};
+	std::vector<std::array<Vector2, 3>> pieces{};
+	for (size_t i = 0; i < cutTriangles.size(); ++i)
+	{
+		const int index{ cutTriangles[i] };
+		edit.oldTriangles.push_back({ index, m_Triangles[index] });
+
+		pieces.clear();
+		TriangulateRemainder(cutTrianglePoints[i], cuts[i], pieces);
+		if (pieces.empty())
+		{
+			m_Triangles[index].neighbors = { { -1, -1, -1 } };
+			m_Triangles[index].isRemoved = true;
+			continue;
+		}
+
+		for (size_t piece = 0; piece < pieces.size(); ++piece)
+		{
+			const int slot{ piece == 0 ? index : static_cast<int>(m_Triangles.size()) };
+			if (piece != 0)
+				m_Triangles.emplace_back();
+
+			NavTriangle& navTriangle = m_Triangles[slot];
+			navTriangle.points = pieces[piece];
+			navTriangle.neighbors = { { -1, -1, -1 } };
+			navTriangle.center = (pieces[piece][0] + pieces[piece][1] + pieces[piece][2]) / 3.f;
+			navTriangle.isRemoved = false;
+			if (piece != 0)
+				AddToGrid(slot, &edit.gridCells);
+			newTriangles.push_back(slot);
+		}
+	}
+
+	//Link the new triangles to each other and to the border by their edges,
+	//the points on shared edges are computed the same way on both sides so they match exactly
+	struct EdgeEntry
+	{
+		Vector2 first{};
+		Vector2 second{};
+		int triangle{};
+		int edge{};
+	};
+	std::vector<EdgeEntry> edges{};
+	const auto addEdge = [this, &edges](int triangle, int edge)
+	{
+		Vector2 first{ m_Triangles[triangle].points[edge] };
+		Vector2 second{ m_Triangles[triangle].points[(edge + 1) % 3] };
+		if (second.x < first.x || (second.x == first.x && second.y < first.y))
+			std::swap(first, second);
+		edges.push_back({ first, second, triangle, edge });
+	};
+	for (const int index : newTriangles)
+	{
+		for (int edge = 0; edge < 3; ++edge)
+			addEdge(index, edge);
+	}
+	for (const int index : borderTriangles)
+	{
+		for (int edge = 0; edge < 3; ++edge)
+		{
+			if (m_Triangles[index].neighbors[edge] == -1)
+				addEdge(index, edge);
+		}
+	}
+
+	const auto isLess = [](const EdgeEntry& a, const EdgeEntry& b)
+	{
+		if (a.first.x != b.first.x) return a.first.x < b.first.x;
+		if (a.first.y != b.first.y) return a.first.y < b.first.y;
+		if (a.second.x != b.second.x) return a.second.x < b.second.x;
+		return a.second.y < b.second.y;
+	};
+	std::sort(edges.begin(), edges.end(), isLess);
+	for (size_t i = 0; i + 1 < edges.size();)
+	{
+		const EdgeEntry& a = edges[i];
+		const EdgeEntry& b = edges[i + 1];
+		if (a.first == b.first && a.second == b.second)
+		{
+			m_Triangles[a.triangle].neighbors[a.edge] = b.triangle;
+			m_Triangles[b.triangle].neighbors[b.edge] = a.triangle;
+			i += 2;
+		}
+		else
+			++i;
+	}
+}
+
+void NavMesh::UndoEdit(const MeshEdit& edit)
+{
+	//The added triangles are the last ones in their cells, later edits were undone already
+	for (auto it = edit.gridCells.rbegin(); it != edit.gridCells.rend(); ++it)
+		m_Grid[*it].pop_back();
+
+	m_Triangles.resize(edit.triangleCount);
+	for (auto it = edit.oldTriangles.rbegin(); it != edit.oldTriangles.rend(); ++it)
+		m_Triangles[it->first] = it->second;
+}
+
+void NavMesh::ClearPathCache()
+{
+	m_CostCache.clear();
+	m_CurrentPath.clear();
+	m_CurrentCorridor.clear();
+}
+
+int NavMesh::GetCellIndex(const Vector2& position) const
+{
+	if (m_Grid.empty())
+		return -1;
+
+	const int column = static_cast<int>(floorf((position.x - m_GridOrigin.x) / m_CellSize));
+	const int row = static_cast<int>(floorf((position.y - m_GridOrigin.y) / m_CellSize));
+	if (column < 0 || column >= m_GridColumns || row < 0 || row >= m_GridRows)
+		return -1;
+
+	return row * m_GridColumns + column;
+}
+
+int NavMesh::FindNearestTriangle(const Vector2& position, float maxDistance, Vector2& closestPoint) const
+{
+	if (m_Grid.empty())
+		return -1;
+
+	const int centerColumn = Clamp(static_cast<int>(floorf((position.x - m_GridOrigin.x) / m_CellSize)), 0, m_GridColumns - 1);
+	const int centerRow = Clamp(static_cast<int>(floorf((position.y - m_GridOrigin.y) / m_CellSize)), 0, m_GridRows - 1);
+	const int maxRing = max(m_GridColumns, m_GridRows);
+
+	int nearestTriangle{ -1 };
+	float nearestDistanceSquared{ FLT_MAX };
+
+	//Search the cells in rings around the position, stop as soon as the next ring can't contain anything closer
+	for (int ring = 0; ring <= maxRing; ++ring)
+	{
+		for (int row = centerRow - ring; row <= centerRow + ring; ++row)
+		{
+			if (row < 0 || row >= m_GridRows)
+				continue;
+
+			for (int column = centerColumn - ring; column <= centerColumn + ring; ++column)
+			{
+				if (column < 0 || column >= m_GridColumns)
+					continue;
+				//Only the border of the ring, the inside was done already
+				if (row != centerRow - ring && row != centerRow + ring && column != centerColumn - ring && column != centerColumn + ring)
+					continue;
+
+				for (const int index : m_Grid[row * m_GridColumns + column])
+				{
+					const NavTriangle& triangle = m_Triangles[index];
+					if (triangle.isRemoved)
+						continue;
+
+					const Vector2 point = ClosestPointOnTriangle(position, triangle.points[0], triangle.points[1], triangle.points[2]);
+					const float distanceSquared = DistanceSquared(position, point);
+					if (distanceSquared < nearestDistanceSquared)
+					{
+						nearestDistanceSquared = distanceSquared;
+						nearestTriangle = index;
+						closestPoint = point;
+					}
+				}
+			}
+		}
+
+		const float searchedDistance{ ring * m_CellSize };
+		if (nearestTriangle != -1 && nearestDistanceSquared <= Square(searchedDistance))
+			break;
+		if (searchedDistance > maxDistance + m_CellSize)
+			break;
+	}
+
+	if (nearestDistanceSquared > Square(maxDistance))
+		return -1;
+	return nearestTriangle;
+}
+
+bool NavMesh::FindCorridor(int startTriangle, int goalTriangle, const Vector2& goal, std::vector<int>& corridor, float& cost) const
+{
+	corridor.clear();
+	cost = 0.f;
+	if (startTriangle == -1 || goalTriangle == -1)
+		return false;
+	if (startTriangle == goalTriangle)
+	{
+		corridor.push_back(startTriangle);
+		return true;
+	}
+
+	//A* over the triangle graph, moving from center to center
+	const size_t count = m_Triangles.size();
+	std::vector<float> costsSoFar(count, FLT_MAX);
+	std::vector<int> cameFrom(count, -1);
+	std::vector<bool> isClosed(count, false);
+
+	using OpenEntry = std::pair<float, int>;
+	std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> openList{};
+	costsSoFar[startTriangle] = 0.f;
+	openList.push({ Distance(m_Triangles[startTriangle].center, goal), startTriangle });
+
+	while (!openList.empty())
+	{
+		const int current = openList.top().second;
+		openList.pop();
+		if (current == goalTriangle)
+			break;
+		if (isClosed[current])
+			continue;
+		isClosed[current] = true;
+
+		const NavTriangle& triangle = m_Triangles[current];
+		for (const int neighbor : triangle.neighbors)
+		{
+			if (neighbor == -1 || isClosed[neighbor])
+				continue;
+
+			const float newCost = costsSoFar[current] + Distance(triangle.center, m_Triangles[neighbor].center);
+			if (newCost < costsSoFar[neighbor])
+			{
+				costsSoFar[neighbor] = newCost;
+				cameFrom[neighbor] = current;
+				openList.push({ newCost + Distance(m_Triangles[neighbor].center, goal), neighbor });
+			}
+		}
+	}
+
+	if (cameFrom[goalTriangle] == -1)
+		return false;
+
+	cost = costsSoFar[goalTriangle];
+	for (int current = goalTriangle; current != -1; current = cameFrom[current])
+		corridor.push_back(current);
+	std::reverse(corridor.begin(), corridor.end());
+	return true;
+}
+
+void NavMesh::StringPull(const Vector2& start, const Vector2& goal, const std::vector<int>& corridor, std::vector<Vector2>& path) const
+{
+	//Portals are the shared edges of the corridor, stored as (left, right) seen in the direction of travel
+	std::vector<std::pair<Vector2, Vector2>> portals{};
+	portals.reserve(corridor.size() + 1);
+	portals.push_back({ start, start });
+	for (size_t i = 0; i + 1 < corridor.size(); ++i)
+	{
+		const NavTriangle& from = m_Triangles[corridor[i]];
+		for (int edge = 0; edge < 3; ++edge)
+		{
+			if (from.neighbors[edge] != corridor[i + 1])
+				continue;
+
+			const Vector2& a = from.points[edge];
+			const Vector2& b = from.points[(edge + 1) % 3];
+			if (Cross(b - from.center, a - from.center) > 0.f)
+				portals.push_back({ a, b });
+			else
+				portals.push_back({ b, a });
+			break;
+		}
+	}
+	portals.push_back({ goal, goal });
+
+	//Simple stupid funnel algorithm
+	//Reference: http://digestingduck.blogspot.com/2010/03/simple-stupid-funnel-algorithm.html
+	path.clear();
+	path.push_back(start);
+
+	Vector2 apex{ start };
+	Vector2 left{ portals[0].first };
+	Vector2 right{ portals[0].second };
+	size_t apexIndex{}, leftIndex{}, rightIndex{};
+
+	for (size_t i = 1; i < portals.size(); ++i)
+	{
+		const Vector2& newLeft = portals[i].first;
+		const Vector2& newRight = portals[i].second;
+
+		//Try to tighten the right side of the funnel
+		if (Cross(right - apex, newRight - apex) >= 0.f)
+		{
+			if (apex == right || Cross(left - apex, newRight - apex) < 0.f)
+			{
+				right = newRight;
+				rightIndex = i;
+			}
+			else
+			{
+				//Right crossed over left, left becomes the new apex
+				path.push_back(left);
+				apex = left;
+				apexIndex = leftIndex;
+				right = apex;
+				rightIndex = apexIndex;
+				i = apexIndex;
+				continue;
+			}
+		}
+
+		//Try to tighten the left side of the funnel
+		if (Cross(left - apex, newLeft - apex) <= 0.f)
+		{
+			if (apex == left || Cross(right - apex, newLeft - apex) > 0.f)
+			{
+				left = newLeft;
+				leftIndex = i;
+			}
+			else
+			{
+				//Left crossed over right, right becomes the new apex
+				path.push_back(right);
+				apex = right;
+				apexIndex = rightIndex;
+				left = apex;
+				leftIndex = apexIndex;
+				i = apexIndex;
+				continue;
+			}
+		}
+	}
+
+	if (path.back() != goal)
+		path.push_back(goal);
+}
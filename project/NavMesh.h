@@ -0,0 +1,125 @@
+#pragma once
+#include "Exam_HelperStructs.h"
+#include "EliteGeometry/EGeometry2DTypes.h"
+#include "EliteGeometry/EGeometry2DBatch.h"
+#include <array>
+#include <unordered_map>
+
+namespace Elite
+{
+	// Plugin side navigation mesh, built from the houses we have seen so far.
+	// The host only gives us the next point on its own path (NavMesh_GetClosestPathPoint),
+	// this one gives us full paths and their lengths so we can plan ahead.
+	class NavMesh final
+	{
+	public:
+		NavMesh() = default;
+		~NavMesh();
+
+		NavMesh(const NavMesh& other) = delete;
+		NavMesh& operator=(const NavMesh& other) = delete;
+		NavMesh(NavMesh&& other) = delete;
+		NavMesh& operator=(NavMesh&& other) = delete;
+
+		void Initialize(const WorldInfo& worldInfo, float agentRadius);
+		bool IsInitialized() const { return m_IsInitialized; }
+
+		// returns true if the house was not known yet, the mesh gets rebuilt on the next Update
+		bool AddHouse(const HouseInfo& houseInfo);
+		void Update();
+
+		// Full funnelled path from start to goal (start and goal included)
+		bool FindPath(const Vector2& start, const Vector2& goal, std::vector<Vector2>& path, float& pathCost) const;
+		// Cheap travel distance estimate, results are cached per triangle pair
+		float EstimateDistance(const Vector2& start, const Vector2& goal) const;
+		// Next point to steer to, the path is reused until the goal changes or the agent leaves the corridor
+		bool GetNextPathPoint(const Vector2& agentPos, const Vector2& goal, Vector2& nextPoint);
+
+		// Cuts a circle out of the mesh without a full rebuild, only the triangles overlapping it get re-triangulated.
+		// Returns the id to give to RemoveObstacle, the obstacle stays cut when the mesh gets rebuilt for a new house
+		int AddObstacle(const Vector2& center, float radius);
+		// Restores the triangles the obstacle replaced
+		void RemoveObstacle(int obstacleId);
+
+		int GetTriangleIndex(const Vector2& position) const;
+		const Polygon* GetPolygon() const { return m_pPolygon; }
+		const std::vector<Vector2>& GetCurrentPath() const { return m_CurrentPath; }
+
+	private:
+		void Rebuild();
+		void BuildGraph();
+		void BuildGrid();
+
+		bool FindPath(const Vector2& start, const Vector2& goal, std::vector<Vector2>& path, float& pathCost, std::vector<int>& corridor) const;
+		int GetCellIndex(const Vector2& position) const;
+		int FindNearestTriangle(const Vector2& position, float maxDistance, Vector2& closestPoint) const;
+		bool FindCorridor(int startTriangle, int goalTriangle, const Vector2& goal, std::vector<int>& corridor, float& cost) const;
+		void StringPull(const Vector2& start, const Vector2& goal, const std::vector<int>& corridor, std::vector<Vector2>& path) const;
+
+		struct NavTriangle
+		{
+			std::array<Vector2, 3> points{};
+			std::array<int, 3> neighbors{ { -1, -1, -1 } }; //neighbor over edge (p1,p2), (p2,p3), (p3,p1)
+			Vector2 center{};
+			bool isRemoved{ false }; //fully covered by an obstacle, the slot is kept so the indices stay valid
+		};
+
+		struct Obstacle
+		{
+			int id{};
+			Vector2 center{};
+			float radius{};
+		};
+
+		// Everything an obstacle cut changed, so it can be undone without a rebuild
+		struct MeshEdit
+		{
+			size_t triangleCount{}; //triangles from this index on were added by the cut
+			std::vector<std::pair<int, NavTriangle>> oldTriangles{}; //triangles changed in place, as they were before the cut
+			std::vector<int> gridCells{}; //cells the added triangles were pushed in
+		};
+
+		void CutObstacle(const Obstacle& obstacle, MeshEdit& edit);
+		void UndoEdit(const MeshEdit& edit);
+		void AddToGrid(int triangleIndex, std::vector<int>* pAddedCells = nullptr);
+		void ClearPathCache();
+
+		Polygon* m_pPolygon{ nullptr };
+		std::vector<NavTriangle> m_Triangles{};
+
+		// Uniform grid over the world, each cell stores the triangles overlapping it
+		std::vector<std::vector<int>> m_Grid{};
+		Vector2 m_GridOrigin{};
+		int m_GridColumns{};
+		int m_GridRows{};
+		float m_CellSize{ 8.f };
+
+		Vector2 m_WorldMin{};
+		Vector2 m_WorldMax{};
+		float m_AgentRadius{};
+		// Triangulation cache, relative to the working directory. Read in Initialize and written in the destructor,
+		// the rebuilds in between only use the copy in memory. Entries are keyed on the set of houses and the settings,
+		// so they never go stale, deleting the file is always safe. Empty turns the cache off
+		std::string m_CacheFilePath{ "NavMeshCache.bin" };
+		TriangulationCache m_TriangulationCache{};
+		// Triangulates the courtyard islands of a rebuild next to the outer shape
+		WorkerPool m_WorkerPool{};
+		std::vector<HouseInfo> m_Houses{};
+		bool m_IsInitialized = false;
+		bool m_IsDirty = false;
+
+		// Obstacles in the order they were cut, every one has its edit at the same index.
+		// The edits can only be undone last to first
+		std::vector<Obstacle> m_Obstacles{};
+		std::vector<MeshEdit> m_Edits{};
+		int m_NextObstacleId{};
+
+		mutable std::unordered_map<uint64_t, float> m_CostCache{};
+
+		// Cached path for GetNextPathPoint
+		std::vector<Vector2> m_CurrentPath{};
+		std::vector<int> m_CurrentCorridor{};
+		Vector2 m_CurrentGoal{};
+		size_t m_CurrentPathIndex{};
+	};
+}
@@ -25,12 +25,18 @@ void Plugin::Initialize(IBaseInterface* pInterface, PluginInfo& info)
 void Plugin::DllInit()
 {
 	//Called when the plugin is loaded
+	Elite::InitializeSimd();
+#if defined(ELITE_FAST_TRIG) && defined(_DEBUG)
+	Elite::PrintFastMathReport();
+#endif
 }
 
 //Called only once
 void Plugin::DllShutdown()
 {
 	//Called wheb the plugin gets unloaded
+	//The bot's nav mesh writes its triangulation cache when it's destroyed
+	SAFE_DELETE(m_pBot);
 }
 
 //Called only once, during initialization
@@ -51,12 +57,24 @@ void Plugin::InitGameDebugParams(GameDebugParams& params)
 	params.PrintDebugMessages = false;
 	params.ShowDebugItemNames = true;
 	params.Seed = 25;
+
+	//Same seed as the level, so the plugin's random numbers are reproducible too
+	Elite::SeedRandom(static_cast<uint64_t>(params.Seed));
 }
 
 //Only Active in DEBUG Mode
 //(=Use only for Debug Purposes)
 void Plugin::Update(float dt)
 {
+#ifdef ELITE_DEBUG_DRAW
+	//F1, F2, F3: toggle the debug drawing of the navigation, houses and entities
+	for (int channel = 0; channel < static_cast<int>(Elite::DebugChannel::Count); ++channel)
+	{
+		if (m_pInterface->Input_IsKeyboardKeyUp(static_cast<Elite::InputScancode>(Elite::eScancode_F1 + channel)))
+			m_pBot->GetDebugDraw().ToggleChannel(static_cast<Elite::DebugChannel>(channel));
+	}
+#endif
+
 	////Demo Event Code
 	////In the end your AI should be able to walk around without external input
 	//if (m_pInterface->Input_IsMouseButtonUp(Elite::InputMouseButton::eLeft))
@@ -214,6 +232,12 @@ void Plugin::Render(float dt) const
 {
 	//This Render function should only contain calls to Interface->Draw_... functions
 	//m_pInterface->Draw_SolidCircle(m_Target, .7f, { 0,0 }, { 1, 0, 0 });
+#ifdef ELITE_DEBUG_DRAW
+	m_pBot->GetDebugDraw().Flush(m_pInterface);
+#endif
+#ifdef ELITE_BT_PROFILER
+	m_pBot->RenderBehaviorProfiler();
+#endif
 }
 
 vector<HouseInfo> Plugin::GetHousesInFOV() const
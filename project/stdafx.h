@@ -33,6 +33,7 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_syswm.h>
 
+//#define ELITE_FAST_TRIG //polynomial sin, cos and atan2 in the orientation helpers, see EFastMath.h
 #include "EliteMath/EMath.h"
 #include "EliteInput/EInputCodes.h"
 #include "EliteInput/EInputData.h"